@@ -0,0 +1,56 @@
+/*
+ * Example replacement-policy plugin: exact LRU, one stamp per way.
+ *
+ *     cc -O2 -shared -fPIC -Iinclude examples/plugins/lru_policy.c -o liblru_policy.so
+ *     cache_simulator -f trace.txt -w 8 -p plugin:./liblru_policy.so
+ */
+#include "policy_plugin.h"
+
+typedef struct lru_set {
+    uint64_t clock;
+    uint64_t stamps[];   /* one per way */
+} lru_set;
+
+static lru_set* set_state(const cachesim_sets* sets, uint32_t set) {
+    return (lru_set*)(sets->state + (size_t)set * sets->stride);
+}
+
+static size_t state_size(uint32_t ways) {
+    return sizeof(lru_set) + ways * sizeof(uint64_t);
+}
+
+/* Zeroed state is already an empty LRU order */
+static void init_sets(const cachesim_sets* sets, uint32_t first, uint32_t count) {
+    (void)sets;
+    (void)first;
+    (void)count;
+}
+
+/* Hits and fills both make the way the most recently used */
+static void on_events(const cachesim_sets* sets, const cachesim_event* events, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        lru_set* s = set_state(sets, events[i].set);
+        s->stamps[events[i].way] = ++s->clock;
+    }
+}
+
+static uint32_t choose_victim(const cachesim_sets* sets, uint32_t set, uint64_t tag, uint64_t pc) {
+    (void)tag;
+    (void)pc;
+    const lru_set* s = set_state(sets, set);
+    uint32_t oldest = 0;
+    for (uint32_t way = 1; way < sets->ways; ++way) {
+        if (s->stamps[way] < s->stamps[oldest]) {
+            oldest = way;
+        }
+    }
+    return oldest;
+}
+
+static const cachesim_policy policy = {
+    CACHESIM_POLICY_ABI_VERSION, "example-lru", state_size, init_sets, on_events, choose_victim,
+};
+
+const cachesim_policy* cachesim_policy_v1(void) {
+    return &policy;
+}
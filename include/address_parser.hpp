@@ -1,9 +1,9 @@
 #pragma once
 #include <string>
-#include <unordered_map>
 #include <bitset>
 #include <sstream>
 #include <cstdint>
+#include "block_bitmap.hpp"
 
 class AddressParser {
 public:
@@ -12,6 +12,8 @@ public:
         uint64_t index;
         uint64_t offset;
         uint64_t fullAddress;
+        uint64_t blockAddress;
+        uint64_t pc;   // instruction making the access, or 0 when the trace has none
         bool isColdAccess;
         
         // Declare the function but don't define it here
@@ -20,13 +22,19 @@ public:
 
     AddressParser(int N, int blockSize, int numSets);
     ParsedAddress parseAddress(const std::string& addrStr);
+    ParsedAddress parseAddress(uint64_t addr, uint64_t pc = 0);
+
+    [[nodiscard]] uint64_t setIndex(uint64_t addr) const {
+        return (addr >> offsetBits) & ((1ULL << indexBits) - 1);
+    }
+    [[nodiscard]] uint64_t blockAddress(uint64_t addr) const { return addr >> offsetBits; }
 
 private:
     const int N;
     const int offsetBits;
     const int indexBits;
     const int tagBits;
-    std::unordered_map<uint64_t, bool> seenAddresses;
+    BlockBitmap seenBlocks;   // blocks referenced so far, for cold misses
     
     void validateConfiguration();
 };
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// One-pass LRU simulation of every power-of-two set count and every
+// associativity up to a limit (Hill & Smith all-associativity simulation).
+//
+// Each set count keeps per-set LRU stacks truncated to maxWays entries; a
+// reference found at depth d hits in every cache of that set count with more
+// than d ways. LRU inclusion means a block's depth can only shrink as sets are
+// split, so once a block is on top of its stack it is on top for every finer
+// mapping and the remaining levels need no update.
+class AllAssociativitySimulator {
+public:
+    AllAssociativitySimulator(int blockSize, int maxIndexBits, int maxWays);
+
+    void access(uint64_t address);
+
+    [[nodiscard]] uint64_t getHits(int indexBits, int ways) const;
+    [[nodiscard]] uint64_t getMisses(int indexBits, int ways) const;
+    [[nodiscard]] uint64_t getTotalAccesses() const { return totalAccesses; }
+    [[nodiscard]] int getMaxIndexBits() const { return maxIndexBits; }
+    [[nodiscard]] int getMaxWays() const { return maxWays; }
+    [[nodiscard]] int getBlockSize() const { return 1 << offsetBits; }
+
+private:
+    struct Level {
+        std::vector<uint64_t> blocks;   // numSets * maxWays, most recent first
+        std::vector<uint32_t> fill;     // valid entries per set
+        std::vector<uint64_t> depthHits; // hits found at each stack depth
+    };
+
+    const int offsetBits;
+    const int maxIndexBits;
+    const int maxWays;
+    uint64_t totalAccesses{0};
+    std::vector<Level> levels;
+};
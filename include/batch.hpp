@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "policies.hpp"
+#include "stats.hpp"
+
+// Statistics for one trace file of a batch run
+struct BatchResult {
+    std::string filename;
+    CacheStats stats;
+    std::string error;   // empty on success
+};
+
+// Counter-only simulation of one trace file, streaming it unless OPTIMAL
+// needs the whole trace for lookahead
+CacheStats simulateTraceFile(int N, int B, int I, int ways, ReplacementPolicy policy,
+                             const std::string& filename, const PolicyOptions& options = {});
+
+// Simulate every file with its own cache, several files at a time on a
+// thread pool. A file that fails to load is reported in its result and does
+// not stop the others; results keep the order of `files`.
+std::vector<BatchResult> runBatch(int N, int B, int I, int ways, ReplacementPolicy policy,
+                                  const std::vector<std::string>& files, int threads,
+                                  const PolicyOptions& options = {});
@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+// Set of block numbers stored as a paged bitmap: 4096 blocks per 512-byte
+// page, pages allocated on first touch and found through a hash map, so
+// sparse 64-bit address spaces cost one bit per block in touched regions.
+class BlockBitmap {
+public:
+    // Mark a block as seen; returns whether it had been seen before
+    bool testAndSet(uint64_t block) {
+        uint64_t* page = findPage(block >> PAGE_BITS);
+        uint64_t bit = block & (PAGE_BLOCKS - 1);
+        uint64_t mask = uint64_t{1} << (bit & 63);
+        uint64_t& word = page[bit >> 6];
+        bool seen = (word & mask) != 0;
+        word |= mask;
+        count += seen ? 0 : 1;
+        return seen;
+    }
+
+    [[nodiscard]] bool contains(uint64_t block) const;
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] size_t memoryBytes() const { return pages.size() * sizeof(Page); }
+    void clear();
+
+private:
+    static constexpr int PAGE_BITS = 12;
+    static constexpr uint64_t PAGE_BLOCKS = uint64_t{1} << PAGE_BITS;
+
+    using Page = std::array<uint64_t, PAGE_BLOCKS / 64>;
+
+    std::unordered_map<uint64_t, std::unique_ptr<Page>> pages;
+    uint64_t lastPageNumber{UINT64_MAX};
+    uint64_t* lastPage{nullptr};
+    size_t count{0};
+
+    uint64_t* findPage(uint64_t pageNumber) {
+        if (pageNumber != lastPageNumber) {
+            auto& page = pages[pageNumber];
+            if (!page) {
+                page = std::make_unique<Page>();
+                page->fill(0);
+            }
+            lastPageNumber = pageNumber;
+            lastPage = page->data();
+        }
+        return lastPage;
+    }
+};
@@ -2,8 +2,11 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <span>
 #include "cache_set.hpp"
 #include "address_parser.hpp"
+#include "shadow_cache.hpp"
+#include "stats.hpp"
 
 class Cache {
 public:
@@ -15,27 +18,75 @@ public:
         char hitMiss;
         bool isColdMiss;
         bool isConflictMiss;
+        bool isCapacityMiss;
         int replacedWay;
         std::string replacementInfo;
     };
 
-    Cache(int N, int B, int I, int ways = 1, ReplacementPolicy policy = ReplacementPolicy::LRU);
+    // setSampleFraction < 1 simulates only that fraction of sets, chosen by
+    // hashing the set index; accesses to other sets are counted but skipped
+    Cache(int N, int B, int I, int ways = 1, ReplacementPolicy policy = ReplacementPolicy::LRU,
+          double setSampleFraction = 1.0, const PolicyOptions& options = {});
     AccessResult access(const std::string& addrStr);
+
+    // pc is the instruction making the access, read only by PC-aware policies
+    AccessResult access(uint64_t address, uint64_t pc = 0);
+
+    // Counter-only access for analysis modes: no formatting, timing or history
+    bool simulate(uint64_t address, uint64_t pc = 0);
+
     const CacheStats& getStats() const;
+    int getAddressBits() const { return N; }
+    int getBlockSize() const { return blockSize; }
+    int getNumSets() const { return numSets; }
 
-    // Getter for sets to support OPTIMAL policy preprocessing
-    const std::vector<CacheSet>& getSets() const { return sets; }
-    std::vector<CacheSet>& getSets() { return sets; }
+    // Block sizes and set counts are rounded up to powers of two
+    static int roundToPowerOfTwo(int value);
+    SetSampleEstimate getSampleEstimate() const;
+
+    // OPTIMAL looks ahead: give it the trace about to be simulated, or next-use
+    // times already computed for it at this block size (see computeNextUse),
+    // either shared or borrowed from storage that outlives the cache
+    void setOptimalTrace(const std::vector<uint64_t>& trace);
+    void setNextUse(std::shared_ptr<const std::vector<uint64_t>> nextUse);
+    void setNextUse(std::span<const uint64_t> nextUse);
 
 private:
+    static constexpr uint32_t NOT_SAMPLED = UINT32_MAX;
+
+    struct Outcome {
+        bool hit;
+        bool isColdMiss;
+        bool isConflictMiss;
+        bool isCapacityMiss;
+        size_t way;
+        bool evicted;
+        uint64_t evictedTag;
+    };
+
     const int N;
     const int blockSize;
     const int numSets;
     const int ways;
-    std::vector<CacheSet> sets;
+    std::vector<uint32_t> setSlot;   // set index -> position in sets
+    std::unique_ptr<SetArray> sets;  // simulated (sampled) sets only
     AddressParser parser;
+    ShadowLRU shadow;   // fully-associative LRU of equal capacity, for 3C split
     ReplacementPolicy policy;
     CacheStats stats;
-    
+
+    // Per simulated set counters, for the sampling confidence interval
+    std::vector<uint64_t> slotAccesses;
+    std::vector<uint64_t> slotHits;
+    uint64_t skippedAccesses{0};
+
+    // OPTIMAL look-ahead and the position of the next access in that trace
+    std::shared_ptr<const std::vector<uint64_t>> nextUseOwner;
+    std::span<const uint64_t> nextUse;
+    bool lookahead{false};   // the policy needs nextUse on every access
+    uint64_t tracePosition{0};
+
+    static std::vector<uint32_t> selectSets(int numSets, double fraction);
+    Outcome lookupAndFill(const AddressParser::ParsedAddress& parsed, uint32_t slot, uint64_t position);
     std::string formatHex(uint64_t value) const;
-};
\ No newline at end of file
+};
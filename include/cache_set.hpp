@@ -1,82 +1,151 @@
 #pragma once
 
-#include <vector>
+#include <cstdint>
 #include <memory>
-#include <random>
-#include <chrono>
-#include <map>
-#include <unordered_map>
-#include <cmath>
-#include <deque>
-#include <limits>
-#include <algorithm>
+#include <vector>
 
 #include "cache_entry.hpp"
 #include "policies.hpp"
-#include "stats.hpp"
+#include "replacement.hpp"
 
+// One set of lines under a replacement policy known at compile time, so
+// lookups and victim choice inline the policy instead of branching on it
+template <CachePolicy Policy>
 class CacheSet {
+public:
+    // Set `set` of a cache; only set-indexed policies see the index
+    explicit CacheSet(int ways, const PolicyOptions& options = {}, size_t set = 0)
+        requires(!SharedStatePolicy<Policy>)
+        : entries(ways), policy(makePolicy(ways, options, set)) {}
+
+    // Set `set` of a cache whose sets share `shared`
+    CacheSet(int ways, const PolicyOptions& options, SharedStateOf<Policy>& shared, size_t set)
+        requires SharedStatePolicy<Policy>
+        : entries(ways), policy(ways, options, shared, set) {}
+
+    // On a hit, wayIndex is the matching way and the policy sees the hit.
+    // The set fills in info.tag itself.
+    [[nodiscard]] bool lookup(uint64_t tag, size_t& wayIndex, AccessInfo info = {}) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].valid && entries[i].tag == tag) {
+                wayIndex = i;
+                info.tag = tag;
+                policy.onHit(i, info);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The first invalid way, or the policy's choice for newTag once the
+    // set is full
+    [[nodiscard]] size_t findVictim(uint64_t newTag, AccessInfo info = {}) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (!entries[i].valid) {
+                return i;
+            }
+        }
+        info.tag = newTag;
+        return policy.victim(info);
+    }
+
+    // Fill a way on a miss, evicting whatever it held
+    void fill(size_t wayIndex, uint64_t tag, AccessInfo info = {}) {
+        CacheEntry& entry = entries[wayIndex];
+        if (entry.valid) {
+            policy.onEvict(wayIndex);
+        }
+        entry.tag = tag;
+        entry.valid = true;
+        entry.dirty = false;
+        info.tag = tag;
+        policy.onFill(wayIndex, info);
+    }
+
+    [[nodiscard]] const std::vector<CacheEntry>& getEntries() const { return entries; }
+    [[nodiscard]] Policy& getPolicy() { return policy; }
+
 private:
-    // Core cache storage and configuration
     std::vector<CacheEntry> entries;
-    ReplacementPolicy policy;
-    uint64_t accessCount{0};
-    
-    // Trace analysis for optimal replacement
-    struct FutureAccess {
-        std::vector<size_t> positions;    // All positions where this address appears
-        
-        // Get next access position after given position
-        size_t getNextAccess(size_t currentPos) const {
-            auto it = std::lower_bound(positions.begin(), positions.end(), currentPos + 1);
-            return it != positions.end() ? *it : std::numeric_limits<size_t>::max();
+    Policy policy;
+
+    static Policy makePolicy(int ways, const PolicyOptions& options, size_t set) {
+        if constexpr (SetIndexedPolicy<Policy>) {
+            return Policy(ways, options, set);
+        } else {
+            return Policy(ways, options);
         }
+    }
+};
+
+// The sets of one cache behind a runtime policy choice. Callers pay one
+// virtual call per access; everything below it is specialised per policy.
+class SetArray {
+public:
+    struct Outcome {
+        bool hit;
+        size_t way;
+        bool evicted;
+        uint64_t evictedTag;
     };
-    
-    // Enhanced cache state tracking
-    struct CacheState {
-        size_t currentPosition{0};          // Current position in trace
-        std::vector<uint64_t> fullTrace;    // Complete memory trace
-        int offsetBits{0};                  // Number of bits for block offset
-        int indexBits{0};                   // Number of bits for set index
-        std::unordered_map<uint64_t, FutureAccess> futureMap;  // Tag -> future accesses map
-    } state;
-
-    // Support for other replacement policies
-    mutable std::mt19937 gen{std::random_device{}()};
-    mutable std::uniform_int_distribution<size_t> dis;
-    std::deque<size_t> fifoQueue;
-
-    // Replacement policy implementations
-    [[nodiscard]] size_t findLRUVictim() const;
-    [[nodiscard]] size_t findMRUVictim() const;
-    [[nodiscard]] size_t findFIFOVictim() const;
-    [[nodiscard]] size_t findRandomVictim() const;
-    [[nodiscard]] size_t findOptimalVictim(uint64_t newTag);
-    
-    // Optimal policy helpers
-    [[nodiscard]] size_t getNextAccess(uint64_t tag) const;
-    void updateOptimalState();
-    void preprocessTrace(const std::vector<uint64_t>& trace);
 
+    virtual ~SetArray() = default;
+
+    virtual Outcome access(size_t set, uint64_t tag, const AccessInfo& info) = 0;
+
+    // Whether accesses must carry AccessInfo::nextUse (OPTIMAL)
+    [[nodiscard]] virtual bool needsNextUse() const = 0;
+    [[nodiscard]] virtual size_t size() const = 0;
+};
+
+template <CachePolicy Policy>
+class PolicySetArray final : public SetArray {
 public:
-    // Constructors and assignment operators
-    CacheSet() = default;
-    explicit CacheSet(int ways, int blockSize, ReplacementPolicy p);
-    CacheSet(const CacheSet& other);
-    CacheSet(CacheSet&& other) noexcept;
-    CacheSet& operator=(const CacheSet& other);
-    CacheSet& operator=(CacheSet&& other) noexcept;
-
-    // Core cache operations
-    [[nodiscard]] bool lookup(uint64_t tag, size_t& wayIndex);
-    void insert(uint64_t tag);
-    size_t findVictim(uint64_t newTag);
-    void setOptimalTrace(const std::vector<uint64_t>& trace);
-
-    // Accessors
-    [[nodiscard]] std::vector<CacheEntry>& getEntries() { return entries; }
-    [[nodiscard]] const std::vector<CacheEntry>& getEntries() const { return entries; }
-    
-    friend class Cache;
-};
\ No newline at end of file
+    // Slot i holds cache set sampledSets[i], or set i when no sample is
+    // given. Shared state always spans all numSets sets, so sampling keeps
+    // each set's role (leader, OPTgen sample, random stream) from the whole
+    // cache.
+    PolicySetArray(size_t numSets, int ways, const PolicyOptions& options,
+                   const std::vector<uint32_t>& sampledSets = {}) {
+        size_t slots = sampledSets.empty() ? numSets : sampledSets.size();
+        sets.reserve(slots);
+        if constexpr (SharedStatePolicy<Policy>) {
+            shared = std::make_unique<SharedStateOf<Policy>>(numSets, options);
+            for (size_t i = 0; i < slots; ++i) {
+                sets.emplace_back(ways, options, *shared, sampledSets.empty() ? i : sampledSets[i]);
+            }
+        } else {
+            for (size_t i = 0; i < slots; ++i) {
+                sets.emplace_back(ways, options, sampledSets.empty() ? i : sampledSets[i]);
+            }
+        }
+    }
+
+    Outcome access(size_t set, uint64_t tag, const AccessInfo& info) override {
+        CacheSet<Policy>& target = sets[set];
+        Outcome outcome{};
+        outcome.hit = target.lookup(tag, outcome.way, info);
+        if (!outcome.hit) {
+            outcome.way = target.findVictim(tag, info);
+            const CacheEntry& entry = target.getEntries()[outcome.way];
+            outcome.evicted = entry.valid;
+            outcome.evictedTag = entry.tag;
+            target.fill(outcome.way, tag, info);
+        }
+        return outcome;
+    }
+
+    [[nodiscard]] bool needsNextUse() const override { return policyNeedsNextUse<Policy>(); }
+    [[nodiscard]] size_t size() const override { return sets.size(); }
+
+private:
+    // Behind a pointer so the sets' references to it survive moves
+    std::unique_ptr<SharedStateOf<Policy>> shared;
+    std::vector<CacheSet<Policy>> sets;
+};
+
+// Sets for a policy named on the command line; see PolicySetArray for
+// sampledSets
+std::unique_ptr<SetArray> makeSetArray(ReplacementPolicy policy, size_t numSets, int ways,
+                                       const PolicyOptions& options = {},
+                                       const std::vector<uint32_t>& sampledSets = {});
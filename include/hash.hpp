@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+// splitmix64 finalizer: cheap, well-mixed hash for block and set numbers
+inline uint64_t mixHash(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
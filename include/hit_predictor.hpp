@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "policies.hpp"
+
+// Hash of an instruction address into `bits` bits, so nearby PCs spread
+// over a predictor table instead of sharing its low entries
+inline uint32_t pcSignature(uint64_t pc, int bits) {
+    return static_cast<uint32_t>((pc * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+}
+
+// SHiP's signature history counter table (Wu et al.): one saturating
+// counter per PC signature, raised when a line it filled is hit and lowered
+// when one is evicted unreused. Shared by every set of a cache.
+class ShipTable {
+public:
+    static constexpr int SIGNATURE_BITS = 14;
+    static constexpr uint8_t COUNTER_MAX = 7;
+
+    ShipTable(size_t numSets, const PolicyOptions& options);
+
+    [[nodiscard]] uint32_t signature(uint64_t pc) const { return pcSignature(pc, SIGNATURE_BITS); }
+
+    // Whether lines filled by this signature are expected to be reused
+    [[nodiscard]] bool predictsReuse(uint32_t signature) const { return counters[signature] != 0; }
+
+    void recordReuse(uint32_t signature) {
+        if (counters[signature] < COUNTER_MAX) {
+            counters[signature]++;
+        }
+    }
+
+    void recordDead(uint32_t signature) {
+        if (counters[signature] > 0) {
+            counters[signature]--;
+        }
+    }
+
+private:
+    std::vector<uint8_t> counters;
+};
+
+// OPTgen (Jain and Lin): replays the recent accesses of one set to tell
+// whether Belady's OPT, with the set's capacity, would have hit on a
+// reuse. Liveness intervals are tracked over the last 8 x ways accesses in
+// fixed-size circular arrays; older reuses count as OPT misses.
+class OptGen {
+public:
+    struct Verdict {
+        bool reuse;           // the block was seen before, so there is a verdict
+        bool optHit;          // OPT would have kept it since then
+        uint32_t signature;   // signature of the PC that made the previous access
+    };
+
+    explicit OptGen(int ways);
+
+    Verdict access(uint64_t tag, uint32_t signature);
+
+private:
+    struct Entry {
+        uint64_t tag{0};
+        uint64_t time{0};
+        uint32_t signature{0};
+        bool valid{false};
+    };
+
+    uint32_t capacity;
+    std::vector<uint8_t> occupancy;   // lines OPT holds at each time, mod window
+    std::vector<Entry> history;       // last access of recently seen blocks
+    uint64_t now{0};
+};
+
+// Hawkeye's predictor: saturating counters per PC signature, trained by the
+// OPTgen verdicts of a few sampled sets and consulted by every set
+class HawkeyePredictor {
+public:
+    static constexpr int SIGNATURE_BITS = 11;
+    static constexpr uint8_t COUNTER_MAX = 7;
+    static constexpr size_t SAMPLED_SETS = 64;
+
+    HawkeyePredictor(size_t numSets, const PolicyOptions& options);
+
+    [[nodiscard]] uint32_t signature(uint64_t pc) const { return pcSignature(pc, SIGNATURE_BITS); }
+    [[nodiscard]] bool isSampled(size_t set) const { return set % sampleStride == 0; }
+
+    // Cache-friendly PCs load lines that OPT would mostly keep
+    [[nodiscard]] bool isFriendly(uint32_t signature) const {
+        return counters[signature] > COUNTER_MAX / 2;
+    }
+
+    void train(uint32_t signature, bool optHit) {
+        if (optHit && counters[signature] < COUNTER_MAX) {
+            counters[signature]++;
+        } else if (!optHit && counters[signature] > 0) {
+            counters[signature]--;
+        }
+    }
+
+private:
+    size_t sampleStride;
+    std::vector<uint8_t> counters;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "policies.hpp"
+#include "stats.hpp"
+
+// Simulates up to LANES small caches of one block size and associativity in
+// lockstep, one SIMD lane per configuration, so a single pass over the trace
+// evaluates a whole row of a sweep grid (for example every set count of a
+// direct-mapped cache).
+//
+// Every lane's sets live in one shared array of block numbers, most recently
+// used way first. Per access, the lanes' set slots are gathered, compared
+// against the block, and the updated ways are blended and scattered back.
+// With at most two ways the new block always lands in way 0. Way 1 keeps its
+// block on a way-0 hit, or on an MRU eviction from a full set; otherwise it
+// takes the old way 0. Cold misses and the conflict/capacity split come from
+// precomputed LRU stack distances, exactly as a fully-associative shadow
+// cache would classify them.
+//
+// AVX-512 is used when the CPU has it, with a scalar loop over the lanes
+// otherwise; both give identical counts.
+class LaneSimulator {
+public:
+    static constexpr int LANES = 8;
+
+    struct Lane {
+        int numSets;
+        ReplacementPolicy policy;
+    };
+
+    LaneSimulator(int blockSize, int ways, const std::vector<Lane>& lanes);
+
+    // Direct-mapped caches under any built-in policy, and 2-way LRU or MRU;
+    // 2-way tree-PLRU has a single bit and is exactly LRU. Plugins always
+    // take the Cache path, which loads and checks the library.
+    static bool supports(int ways, ReplacementPolicy policy);
+
+    // distances holds the LRU stack distance of every access (see
+    // computeStackDistances), shared by every configuration of the block size
+    void run(const std::vector<uint64_t>& trace, const std::vector<uint64_t>& distances);
+
+    [[nodiscard]] CacheStats getStats(size_t lane) const;
+
+private:
+    static constexpr uint64_t EMPTY = UINT64_MAX;
+
+    const int offsetBits;
+    const int ways;
+    const std::vector<Lane> lanes;
+
+    // Per lane, padded to LANES: table offset, index mask, capacity in
+    // blocks, and whether a full set evicts its most recent way
+    alignas(64) uint64_t base[LANES]{};
+    alignas(64) uint64_t mask[LANES]{};
+    alignas(64) uint64_t capacity[LANES]{};
+    alignas(64) uint64_t evictMru[LANES]{};
+    std::vector<uint64_t> table;
+
+    uint64_t accesses{0};
+    uint64_t coldMisses{0};
+    uint64_t hits[LANES]{};
+    uint64_t conflicts[LANES]{};
+
+    void runScalar(const std::vector<uint64_t>& trace, const std::vector<uint64_t>& distances);
+#if defined(__x86_64__)
+    void runAvx512(const std::vector<uint64_t>& trace, const std::vector<uint64_t>& distances);
+#endif
+};
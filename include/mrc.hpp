@@ -0,0 +1,143 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Miss ratio of a fully-associative cache at a series of capacities
+struct MissRatioCurve {
+    int blockSize{1};
+    uint64_t totalAccesses{0};
+    std::vector<uint64_t> capacities;   // in blocks
+    std::vector<double> missRatios;
+};
+
+// Weighted histogram of stack distances (in blocks) with exact buckets for
+// small distances and eight log-spaced buckets per octave above that, so a
+// curve over any capacity range fits in a few kilobytes.
+class DistanceHistogram {
+public:
+    void add(double distance, double weight = 1.0);
+    void addCold(double weight = 1.0) { coldWeight += weight; }
+    [[nodiscard]] MissRatioCurve toCurve(int blockSize, uint64_t totalAccesses) const;
+
+private:
+    static constexpr uint64_t LINEAR_LIMIT = 64;
+    static constexpr int SUB_BUCKETS = 8;
+
+    static size_t bucketFor(double distance);
+    static uint64_t bucketStart(size_t bucket);
+
+    std::vector<double> buckets;
+    double coldWeight{0};
+};
+
+// Exact LRU stack distances: the number of distinct blocks referenced since a
+// block's previous reference, in O(log n) per access via a Fenwick tree over
+// last-use times. Times are renumbered densely whenever the tree fills, so
+// memory follows the number of tracked blocks rather than the trace length.
+class StackDistanceTracker {
+public:
+    static constexpr uint64_t COLD = UINT64_MAX;
+
+    StackDistanceTracker() : tree(1024, 0) {}
+
+    // Distance of this reference, or COLD on a block's first reference
+    uint64_t access(uint64_t block);
+    void remove(uint64_t block);
+    [[nodiscard]] size_t size() const { return lastUse.size(); }
+
+private:
+    std::vector<uint32_t> tree;
+    uint64_t now{0};
+    std::unordered_map<uint64_t, uint64_t> lastUse;
+
+    void treeAdd(uint64_t pos, int delta);
+    [[nodiscard]] uint64_t treePrefix(uint64_t pos) const;
+    void compactTimes();
+};
+
+// LRU stack distance of every access in a trace (COLD for first references)
+std::vector<uint64_t> computeStackDistances(const std::vector<uint64_t>& trace, int blockSize);
+
+// LRU stack-distance profiler producing a fully-associative miss ratio curve.
+//
+// With a sample rate of 1 every reference is tracked and the curve is exact
+// (Mattson stack distances via StackDistanceTracker).
+// A lower rate enables SHARDS spatial sampling: a block is tracked only when
+// hash(block) mod P < T, and measured distances are scaled by 1/R. A non-zero
+// sample limit switches to fixed-size SHARDS, lowering T whenever more than
+// that many blocks are tracked so memory stays constant.
+class ShardsProfiler {
+public:
+    ShardsProfiler(int blockSize, double sampleRate = 1.0, size_t maxSamples = 0);
+
+    void access(uint64_t address);
+
+    [[nodiscard]] MissRatioCurve getCurve() const;
+    [[nodiscard]] double getSampleRate() const;
+    [[nodiscard]] uint64_t getSampledAccesses() const { return sampledAccesses; }
+    [[nodiscard]] uint64_t getTotalAccesses() const { return totalAccesses; }
+    [[nodiscard]] size_t getTrackedBlocks() const { return tracker.size(); }
+
+private:
+    static constexpr uint64_t HASH_MODULUS = uint64_t{1} << 24;
+
+    const int offsetBits;
+    const size_t maxSamples;
+    uint64_t threshold;
+    uint64_t totalAccesses{0};
+    uint64_t sampledAccesses{0};
+
+    StackDistanceTracker tracker;
+
+    // Tracked blocks by hash, largest first, for fixed-size eviction
+    std::priority_queue<std::pair<uint64_t, uint64_t>> sampleHeap;
+
+    DistanceHistogram histogram;
+
+    static uint64_t hashBlock(uint64_t block);
+    void shrinkSample();
+};
+
+// Belady OPT stack-distance profiler (Mattson's OPT stack with next-use
+// priorities) producing the miss ratio of an optimal fully-associative cache
+// at every capacity from a single pass.
+//
+// On a reference at depth d the block moves to the top and a carried block
+// walks down positions 1..d-1, trading places with any entry whose next use
+// is later, so position i always holds what OPT would evict from a cache of
+// size i. Only those trades move data; a max tree over next-use times finds
+// each one in O(log n) instead of scanning every position.
+class OptStackProfiler {
+public:
+    explicit OptStackProfiler(int blockSize);
+
+    // OPT needs the future, so the whole trace is processed at once
+    void process(const std::vector<uint64_t>& trace);
+
+    [[nodiscard]] MissRatioCurve getCurve() const;
+
+private:
+    static constexpr uint64_t NEVER = UINT64_MAX;
+    static constexpr uint32_t NOT_STACKED = UINT32_MAX;
+
+    const int offsetBits;
+    uint64_t totalAccesses{0};
+
+    // Stack entries are dense block ids; blocks are hashed once, up front
+    std::vector<uint32_t> stack;
+    std::vector<uint64_t> nextUse;   // per block id, time of its next reference
+    std::vector<uint32_t> position;  // per block id, depth in the stack
+    std::vector<uint64_t> maxTree;   // max next use over stack positions
+    std::vector<size_t> dirty;       // leaves whose ancestors are stale
+    size_t leaves{0};
+    DistanceHistogram histogram;
+
+    void place(size_t pos, uint32_t id);
+    void repairTree();
+    void growTree();
+    [[nodiscard]] size_t findLater(size_t from, size_t to, uint64_t time) const;
+};
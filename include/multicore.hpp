@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "cache.hpp"
+#include "policies.hpp"
+#include "stats.hpp"
+
+// How the cores' access streams are merged into one global order
+enum class Interleave {
+    ROUND_ROBIN,   // each core issues `quantum` accesses in turn
+    TIMESTAMP      // lowest timestamp first, ties to the lower core
+};
+
+// One trace per core, each feeding its own private cache; the misses of
+// every private cache go on to one optional shared cache.
+//
+// Every core is a coroutine that suspends before each access, and a
+// deterministic scheduler decides which core issues next, so any number of
+// cores runs on a few host threads and the shared cache always sees the
+// same access order.
+class MultiCoreSimulator {
+public:
+    MultiCoreSimulator(int N, int B, int I, int ways, ReplacementPolicy policy,
+                       const std::vector<std::string>& files, const PolicyOptions& options = {});
+    ~MultiCoreSimulator();
+
+    // Shared cache with the private caches' block size; 0 sets disables it
+    void setSharedCache(int numSets, int ways);
+
+    // Round-robin rounds resume the cores of a round on up to `threads` host
+    // threads once `quantum` is large enough to be worth the hand-off, and
+    // inline otherwise; private caches are independent and their misses reach
+    // the shared cache in core order, so the result does not depend on threads
+    void run(Interleave mode, uint64_t quantum, int threads);
+
+    size_t getCoreCount() const { return cores.size(); }
+    const std::string& getCoreFile(size_t core) const;
+    const CacheStats& getCoreStats(size_t core) const;
+    bool hasSharedCache() const { return shared != nullptr; }
+    const CacheStats& getSharedStats() const;
+
+private:
+    struct Core;
+
+    int N;
+    int blockSize;
+    ReplacementPolicy policy;
+    PolicyOptions options;
+    std::vector<std::unique_ptr<Core>> cores;
+    std::unique_ptr<Cache> shared;
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Trace position of the next reference to the same block, for every access
+// (NEVER_USED if the block is not referenced again). This is the look-ahead
+// the OPTIMAL policy needs.
+//
+// The trace is cut into one chunk per thread and each chunk is scanned
+// backwards independently, recording where every block first appears in it.
+// A block's last access in a chunk cannot see its next use from inside the
+// chunk, so a merge step resolves those boundary accesses against the first
+// appearances in later chunks, again one chunk per thread.
+constexpr uint64_t NEVER_USED = UINT64_MAX;
+
+std::vector<uint64_t> computeNextUse(const std::vector<uint64_t>& trace, int blockSize, int threads);
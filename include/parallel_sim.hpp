@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "policies.hpp"
+#include "stats.hpp"
+
+// Simulates one cache configuration over an in-memory trace on several
+// threads, with results identical to a serial Cache::simulate run.
+//
+// Sets never interact, so the trace is stably radix-partitioned by set index
+// into one shard of consecutive sets per worker, and each worker replays its
+// accesses in trace order against its own sets. The fully-associative shadow
+// behind the conflict/capacity split is cut into trace chunks instead: each
+// chunk's shadow starts from the most recent last uses before it, found from
+// the (itself parallel) next-use pass, so every chunk sees exactly the
+// state a serial shadow would.
+class ShardedSimulator {
+public:
+    ShardedSimulator(int N, int B, int I, int ways, ReplacementPolicy policy, int threads,
+                     const PolicyOptions& options = {});
+
+    CacheStats run(const std::vector<uint64_t>& trace);
+
+private:
+    const int N;
+    const int blockSize;
+    const int numSets;
+    const int ways;
+    const ReplacementPolicy policy;
+    const PolicyOptions options;
+    const int threads;
+
+    struct ShardResult {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t coldMisses{0};
+    };
+
+    void partition(const std::vector<uint64_t>& trace, int shards,
+                   std::vector<size_t>& order, std::vector<size_t>& shardStart) const;
+    ShardResult simulateShard(const std::vector<uint64_t>& trace, const size_t* begin,
+                              const size_t* end, int firstSet, int lastSet,
+                              std::vector<uint8_t>& warmMiss) const;
+};
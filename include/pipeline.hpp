@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "cache.hpp"
+
+// Per-access table mode as three concurrent stages joined by bounded SPSC
+// rings: a reader thread parses the trace into addresses, the calling thread
+// runs them through the cache, and a printer thread formats rows as results
+// arrive. Throughput follows the slowest stage instead of the sum of all
+// three.
+//
+// Each distinct address is simulated once, in order of first appearance.
+// Column widths come from the cache geometry, since rows are printed before
+// the whole trace has been seen. OPTIMAL reads the trace up front to look
+// ahead, so only simulation and printing overlap for it.
+//
+// Returns the results when keepResults is set (for --viz), else nothing.
+std::vector<Cache::AccessResult> runTablePipeline(Cache& cache, const std::string& filename,
+                                                  bool keepResults);
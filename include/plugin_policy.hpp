@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "policies.hpp"
+#include "policy_plugin.h"
+
+// The sets of one cache under a policy loaded from a shared object (see
+// policy_plugin.h): the library, every set's state in one block, and the
+// hits and fills not yet handed to it. Events are sent in batches and only
+// victim choice is a call per access, so the plugin pays one indirect call
+// per miss in a full set rather than one per hook.
+class PluginSets {
+public:
+    static constexpr size_t BATCH = 4096;
+
+    PluginSets(size_t numSets, const PolicyOptions& options);
+    ~PluginSets();
+    PluginSets(const PluginSets&) = delete;
+    PluginSets& operator=(const PluginSets&) = delete;
+
+    // Called by each set's policy; the first call sizes and initialises
+    // the state of every set
+    void attach(int ways);
+
+    void record(uint32_t kind, size_t set, size_t way, uint64_t tag, uint64_t pc) {
+        pending.push_back({kind, static_cast<uint32_t>(set), static_cast<uint32_t>(way), 0, tag, pc});
+        if (pending.size() == BATCH) {
+            flush();
+        }
+    }
+
+    size_t victim(size_t set, uint64_t tag, uint64_t pc);
+
+private:
+    void* library{nullptr};
+    const cachesim_policy* policy{nullptr};
+    std::string path;
+    size_t numSets;
+    std::vector<unsigned char> state;
+    cachesim_sets sets{};
+    std::vector<cachesim_event> pending;
+
+    void flush();
+};
@@ -1,14 +1,44 @@
 #pragma once
 
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <string>
-#include <memory>
+#include <map>
+#include <stdexcept>
 
 enum class ReplacementPolicy {
     LRU,        // Least Recently Used
     MRU,        // Most Recently Used
     OPTIMAL,    // Optimal (Look-ahead) replacement
     FIFO,       // First In First Out
-    RANDOM      // Random replacement
+    RANDOM,     // Random replacement
+    PLRU,       // Tree pseudo-LRU
+    LFU,        // Least Frequently Used
+    ARC,        // Adaptive Replacement Cache
+    SRRIP,      // Static Re-Reference Interval Prediction
+    BRRIP,      // Bimodal RRIP
+    DRRIP,      // Dynamic RRIP, SRRIP and BRRIP by set dueling
+    SHIP,       // Signature-based hit predictor over SRRIP
+    HAWKEYE,    // PC predictor trained on OPT's decisions (OPTgen)
+    LIP,        // LRU with fills inserted at the LRU position
+    BIP,        // LRU with bimodal insertion
+    DIP,        // LRU with LRU-order or bimodal insertion by set dueling
+    LIP_PLRU,   // LIP over tree pseudo-LRU
+    BIP_PLRU,   // BIP over tree pseudo-LRU
+    DIP_PLRU,   // DIP over tree pseudo-LRU
+    PLUGIN      // Loaded at run time from a shared object (-p plugin:PATH)
+};
+
+// Tuning knobs of the policies that have any, set from the command line
+struct PolicyOptions {
+    uint32_t lfuAgingPeriod{0};      // LFU: halve counts every this many set accesses (0 = never)
+    int rripBits{2};                 // RRIP: bits per re-reference prediction value
+    uint32_t duelLeaders{32};        // Set dueling: leader sets per competing policy
+    int pselBits{10};                // Set dueling: width of the PSEL counter
+    uint64_t randomSeed{1};          // RANDOM: seed of every set's generator
+    double bimodalEpsilon{1.0 / 32}; // BIP/DIP: fraction of fills inserted at MRU
+    std::string pluginPath;          // PLUGIN: shared object implementing policy_plugin.h
 };
 
 // Helper function to convert policy to string
@@ -19,32 +49,60 @@ inline std::string getPolicyName(ReplacementPolicy policy) {
         case ReplacementPolicy::OPTIMAL: return "OPTIMAL";
         case ReplacementPolicy::FIFO:    return "FIFO";
         case ReplacementPolicy::RANDOM:  return "RANDOM";
+        case ReplacementPolicy::PLRU:    return "PLRU";
+        case ReplacementPolicy::LFU:     return "LFU";
+        case ReplacementPolicy::ARC:     return "ARC";
+        case ReplacementPolicy::SRRIP:   return "SRRIP";
+        case ReplacementPolicy::BRRIP:   return "BRRIP";
+        case ReplacementPolicy::DRRIP:   return "DRRIP";
+        case ReplacementPolicy::SHIP:    return "SHIP";
+        case ReplacementPolicy::HAWKEYE: return "HAWKEYE";
+        case ReplacementPolicy::LIP:     return "LIP";
+        case ReplacementPolicy::BIP:     return "BIP";
+        case ReplacementPolicy::DIP:     return "DIP";
+        case ReplacementPolicy::LIP_PLRU: return "LIP-PLRU";
+        case ReplacementPolicy::BIP_PLRU: return "BIP-PLRU";
+        case ReplacementPolicy::DIP_PLRU: return "DIP-PLRU";
+        case ReplacementPolicy::PLUGIN:  return "PLUGIN";
         default:                         return "UNKNOWN";
     }
 }
 
-// Centralized PLRUNode definition
-struct PLRUNode {
-    bool bit{false};
-    std::shared_ptr<PLRUNode> left{nullptr};
-    std::shared_ptr<PLRUNode> right{nullptr};
-    
-    // Default constructor
-    PLRUNode() = default;
-    
-    // Copy constructor
-    PLRUNode(const PLRUNode& other) 
-        : bit(other.bit)
-        , left(other.left ? std::make_shared<PLRUNode>(*other.left) : nullptr)
-        , right(other.right ? std::make_shared<PLRUNode>(*other.right) : nullptr) {}
-    
-    // Copy assignment operator
-    PLRUNode& operator=(const PLRUNode& other) {
-        if (this != &other) {
-            bit = other.bit;
-            left = other.left ? std::make_shared<PLRUNode>(*other.left) : nullptr;
-            right = other.right ? std::make_shared<PLRUNode>(*other.right) : nullptr;
-        }
-        return *this;
+// Command-line names of the replacement policies
+inline const std::map<std::string, ReplacementPolicy>& getPolicyNames() {
+    static const std::map<std::string, ReplacementPolicy> names = {
+        {"lru", ReplacementPolicy::LRU},
+        {"mru", ReplacementPolicy::MRU},
+        {"optimal", ReplacementPolicy::OPTIMAL},
+        {"opt", ReplacementPolicy::OPTIMAL},
+        {"fifo", ReplacementPolicy::FIFO},
+        {"random", ReplacementPolicy::RANDOM},
+        {"plru", ReplacementPolicy::PLRU},
+        {"lfu", ReplacementPolicy::LFU},
+        {"arc", ReplacementPolicy::ARC},
+        {"srrip", ReplacementPolicy::SRRIP},
+        {"brrip", ReplacementPolicy::BRRIP},
+        {"drrip", ReplacementPolicy::DRRIP},
+        {"ship", ReplacementPolicy::SHIP},
+        {"hawkeye", ReplacementPolicy::HAWKEYE},
+        {"lip", ReplacementPolicy::LIP},
+        {"bip", ReplacementPolicy::BIP},
+        {"dip", ReplacementPolicy::DIP},
+        {"lip-plru", ReplacementPolicy::LIP_PLRU},
+        {"bip-plru", ReplacementPolicy::BIP_PLRU},
+        {"dip-plru", ReplacementPolicy::DIP_PLRU},
+        {"plugin", ReplacementPolicy::PLUGIN}
+    };
+    return names;
+}
+
+// Look up a command-line policy name, ignoring case
+inline ReplacementPolicy parsePolicyName(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    auto it = getPolicyNames().find(name);
+    if (it == getPolicyNames().end()) {
+        throw std::invalid_argument("Unknown replacement policy: " + name);
     }
-};
+    return it->second;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "address_parser.hpp"
+#include "cache_set.hpp"
+#include "shadow_cache.hpp"
+#include "policies.hpp"
+#include "stats.hpp"
+
+// Simulates one cache geometry under several replacement policies in
+// lockstep, with statistics identical to one Cache run per policy.
+//
+// Each address is decoded once, and the cold-miss bitmap and the
+// fully-associative shadow behind the conflict/capacity split are shared,
+// since neither depends on the policy. Each policy keeps its own sets,
+// specialised for it, so one access makes a single dispatch per policy.
+class PolicyComparison {
+public:
+    PolicyComparison(int N, int B, int I, int ways, const std::vector<ReplacementPolicy>& policies,
+                     const PolicyOptions& options = {});
+
+    // pc is only read by PC-aware policies
+    void access(uint64_t address, uint64_t pc = 0);
+
+    // Needed before the first access when any policy is OPTIMAL
+    void setOptimalTrace(const std::vector<uint64_t>& trace);
+
+    [[nodiscard]] const std::vector<CacheStats>& getStats() const { return stats; }
+    [[nodiscard]] int getBlockSize() const { return blockSize; }
+    [[nodiscard]] int getNumSets() const { return numSets; }
+
+private:
+    const int blockSize;
+    const int numSets;
+    const std::vector<ReplacementPolicy> policies;
+    AddressParser parser;
+    ShadowLRU shadow;
+    std::vector<std::unique_ptr<SetArray>> sets;   // one array per policy
+    std::vector<CacheStats> stats;
+    std::vector<uint64_t> nextUse;   // OPTIMAL look-ahead, per trace position
+    uint64_t position{0};
+};
+
+// Parse a comma-separated list such as "lru,fifo,opt"
+std::vector<ReplacementPolicy> parsePolicyList(const std::string& list);
@@ -0,0 +1,71 @@
+#pragma once
+/*
+ * C ABI for replacement policies loaded at run time with -p plugin:PATH.
+ *
+ * A plugin is a shared object exporting
+ *
+ *     const cachesim_policy* cachesim_policy_v1(void);
+ *
+ * The simulator owns all policy state: one zeroed block of state_size(ways)
+ * bytes per set, laid out back to back with the stride rounded up to a
+ * multiple of alignof(max_align_t), so each set's state may hold any type
+ * and be cast to a struct directly. Hits and fills are delivered in
+ * batches, in access order, and a batch is always flushed before a victim
+ * is asked for, so choose_victim sees every earlier event. Sets never share
+ * state; keep none in globals, since several caches may run on different
+ * threads at once.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CACHESIM_POLICY_ABI_VERSION 1
+
+/* The state of a run of sets: set i's bytes start at state + i * stride,
+   which is aligned to alignof(max_align_t) */
+typedef struct cachesim_sets {
+    unsigned char* state;
+    size_t stride;
+    uint32_t count;
+    uint32_t ways;
+} cachesim_sets;
+
+enum {
+    CACHESIM_HIT = 0,   /* a lookup hit `way` */
+    CACHESIM_FILL = 1   /* a miss filled `way`, replacing whatever it held */
+};
+
+typedef struct cachesim_event {
+    uint32_t kind;
+    uint32_t set;
+    uint32_t way;
+    uint32_t reserved;
+    uint64_t tag;
+    uint64_t pc;   /* instruction making the access, 0 when the trace has none */
+} cachesim_event;
+
+typedef struct cachesim_policy {
+    uint32_t abi_version;   /* CACHESIM_POLICY_ABI_VERSION */
+    const char* name;
+
+    /* Bytes of state each set needs */
+    size_t (*state_size)(uint32_t ways);
+
+    /* Initialise sets [first, first + count); their state arrives zeroed */
+    void (*init_sets)(const cachesim_sets* sets, uint32_t first, uint32_t count);
+
+    /* Apply a batch of hits and fills, in order */
+    void (*on_events)(const cachesim_sets* sets, const cachesim_event* events, size_t count);
+
+    /* The way to evict from a full set for the incoming block */
+    uint32_t (*choose_victim)(const cachesim_sets* sets, uint32_t set, uint64_t tag, uint64_t pc);
+} cachesim_policy;
+
+typedef const cachesim_policy* (*cachesim_policy_entry)(void);
+
+#ifdef __cplusplus
+}
+#endif
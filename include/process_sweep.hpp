@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "sweep.hpp"
+
+// Runs a parameter sweep in forked worker processes instead of threads, for
+// isolation and so workers never contend on one allocator.
+//
+// The coordinator copies the parsed trace once into a shared read-only
+// mapping that every worker inherits, together with OPTIMAL's next-use
+// times for each block size it needs, so nothing is re-parsed, copied or
+// recomputed per process. Workers claim configurations one at a time
+// through a counter in shared memory, simulate each against the mapping,
+// and send fixed-size records back over one pipe: counters, or the error
+// that stopped a configuration. Results keep grid order.
+std::vector<SweepResult> runProcessSweep(int N, const std::vector<SweepConfig>& grid,
+                                         const std::vector<uint64_t>& trace, int processes,
+                                         const PolicyOptions& options = {});
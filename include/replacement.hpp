@@ -0,0 +1,996 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "hit_predictor.hpp"
+#include "plugin_policy.hpp"
+#include "policies.hpp"
+#include "set_dueling.hpp"
+
+// What a replacement policy may learn about the access being made
+struct AccessInfo {
+    uint64_t tag{0};       // tag of the block being accessed or filled
+    uint64_t nextUse{0};   // trace position of the block's next reference
+    uint64_t pc{0};        // instruction making the access, 0 when unknown
+};
+
+// A replacement policy holds the state of one set, built from the number
+// of ways and the command-line tuning options, and is told about every
+// hit, fill and eviction in it. victim() is only asked, with the incoming
+// block, once every way holds a valid line; invalid ways are filled first.
+//
+// Policies whose sets cooperate, such as set dueling, declare a `Shared`
+// type. It is built once per cache from the set count and the options, and
+// handed with the set's index to every set's policy.
+template <typename P>
+concept SharedStatePolicy = requires { typename P::Shared; };
+
+// Policies without shared state that still depend on which set they run,
+// such as per-set random streams, take the set's index as a third
+// constructor argument
+template <typename P>
+concept SetIndexedPolicy = !SharedStatePolicy<P> &&
+                           std::constructible_from<P, int, const PolicyOptions&, size_t>;
+
+// The shared state of a policy, or an empty placeholder for policies without
+struct NoSharedState {
+    NoSharedState(size_t, const PolicyOptions&) {}
+};
+
+template <typename P>
+struct SharedStateTraits {
+    using type = NoSharedState;
+};
+
+template <SharedStatePolicy P>
+struct SharedStateTraits<P> {
+    using type = typename P::Shared;
+};
+
+template <typename P>
+using SharedStateOf = typename SharedStateTraits<P>::type;
+
+template <typename P>
+concept CachePolicy = requires(P policy, size_t way, const AccessInfo& info) {
+    policy.onHit(way, info);
+    policy.onFill(way, info);
+    policy.onEvict(way);
+    { policy.victim(info) } -> std::convertible_to<size_t>;
+} && ((SharedStatePolicy<P> && requires(typename P::Shared& shared) {
+            P(1, PolicyOptions{}, shared, size_t{0});
+        }) || SetIndexedPolicy<P> ||
+        (!SharedStatePolicy<P> && std::constructible_from<P, int, const PolicyOptions&>));
+
+// Policies that look ahead declare `static constexpr bool needsNextUse = true`
+// and get AccessInfo::nextUse filled in; every other policy never pays for it
+template <typename P>
+constexpr bool policyNeedsNextUse() {
+    if constexpr (requires { P::needsNextUse; }) {
+        return P::needsNextUse;
+    } else {
+        return false;
+    }
+}
+
+// Policies that predict from the instruction making each access declare
+// `static constexpr bool needsPc = true`; they need PC-tagged traces
+template <typename P>
+constexpr bool policyNeedsPc() {
+    if constexpr (requires { P::needsPc; }) {
+        return P::needsPc;
+    } else {
+        return false;
+    }
+}
+
+// The recency order of a set is one of two representations, each able to
+// promote a way to most recently used, demote it to least recently used,
+// and name the least recently used way. Insertion policies below work on
+// either.
+
+// Exact LRU order as stamps: promoted ways get a stamp above every other,
+// demoted ways one below every other, counting outward from the middle of
+// the range
+class LruStamps {
+public:
+    explicit LruStamps(int ways) : stamps(ways, 0) {}
+    void promote(size_t way) { stamps[way] = ++top; }
+    void demote(size_t way) { stamps[way] = --bottom; }
+    [[nodiscard]] size_t victim() const {
+        size_t oldest = 0;
+        for (size_t way = 1; way < stamps.size(); ++way) {
+            if (stamps[way] < stamps[oldest]) {
+                oldest = way;
+            }
+        }
+        return oldest;
+    }
+
+private:
+    static constexpr uint64_t MIDDLE = uint64_t{1} << 63;
+
+    std::vector<uint64_t> stamps;
+    uint64_t top{MIDDLE};
+    uint64_t bottom{MIDDLE};
+};
+
+// Tree pseudo-LRU: ways-1 direction bits packed into one word, node i at
+// bit i with children 2i and 2i+1, a leaf for way w at node ways+w. A set
+// bit means the older half is on the right. Promoting a way points every
+// node on its path away from it, demoting points them at it, and the
+// victim is found by following them.
+class PlruTree {
+public:
+    explicit PlruTree(int ways) : ways(static_cast<uint32_t>(ways)) {
+        if (ways < 1 || ways > 64 || (ways & (ways - 1)) != 0) {
+            throw std::invalid_argument("PLRU needs a power-of-two number of ways up to 64");
+        }
+        while ((1 << levels) < ways) {
+            ++levels;
+        }
+    }
+    void promote(size_t way) { point(way, 1); }
+    void demote(size_t way) { point(way, 0); }
+    [[nodiscard]] size_t victim() const {
+        uint64_t node = 1;
+        for (uint32_t level = 0; level < levels; ++level) {
+            node = 2 * node + ((bits >> node) & 1);
+        }
+        return node - ways;
+    }
+
+private:
+    uint64_t bits{0};
+    uint32_t ways;
+    uint32_t levels{0};
+
+    // away = 1 points the path's nodes away from the way, 0 toward it
+    void point(size_t way, uint64_t away) {
+        uint64_t node = 1;
+        for (uint32_t level = levels; level-- > 0;) {
+            uint64_t right = (way >> level) & 1;
+            bits = (bits & ~(uint64_t{1} << node)) | ((right ^ away) << node);
+            node = 2 * node + right;
+        }
+    }
+};
+
+// Evict the way used longest ago
+class LruPolicy {
+public:
+    LruPolicy(int ways, const PolicyOptions&) : order(ways) {}
+    void onHit(size_t way, const AccessInfo&) { order.promote(way); }
+    void onFill(size_t way, const AccessInfo&) { order.promote(way); }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) const { return order.victim(); }
+
+private:
+    LruStamps order;
+};
+
+// Evict the way used most recently
+class MruPolicy {
+public:
+    MruPolicy(int ways, const PolicyOptions&) : lastUsed(ways, 0) {}
+    void onHit(size_t way, const AccessInfo&) { lastUsed[way] = ++clock; }
+    void onFill(size_t way, const AccessInfo&) { lastUsed[way] = ++clock; }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) const {
+        size_t newest = 0;
+        for (size_t way = 1; way < lastUsed.size(); ++way) {
+            if (lastUsed[way] > lastUsed[newest]) {
+                newest = way;
+            }
+        }
+        return newest;
+    }
+
+private:
+    std::vector<uint64_t> lastUsed;
+    uint64_t clock{0};
+};
+
+// Evict the way filled longest ago; hits do not reorder
+class FifoPolicy {
+public:
+    FifoPolicy(int ways, const PolicyOptions&) : filled(ways, 0) {}
+    void onHit(size_t, const AccessInfo&) {}
+    void onFill(size_t way, const AccessInfo&) { filled[way] = ++clock; }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) const {
+        size_t oldest = 0;
+        for (size_t way = 1; way < filled.size(); ++way) {
+            if (filled[way] < filled[oldest]) {
+                oldest = way;
+            }
+        }
+        return oldest;
+    }
+
+private:
+    std::vector<uint64_t> filled;
+    uint64_t clock{0};
+};
+
+// Tree pseudo-LRU, one bit per way of state
+class PlruPolicy {
+public:
+    PlruPolicy(int ways, const PolicyOptions&) : order(ways) {}
+    void onHit(size_t way, const AccessInfo&) { order.promote(way); }
+    void onFill(size_t way, const AccessInfo&) { order.promote(way); }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) const { return order.victim(); }
+
+private:
+    PlruTree order;
+};
+
+// Deterministic bimodal choice: says yes to an epsilon fraction of calls,
+// evenly spread, by accumulating epsilon in 32-bit fixed point
+class BimodalChoice {
+public:
+    explicit BimodalChoice(double epsilon)
+        : step(static_cast<uint64_t>(std::llround(epsilon * static_cast<double>(ONE)))) {
+        if (!(epsilon >= 0.0 && epsilon <= 1.0)) {
+            throw std::invalid_argument("Bimodal epsilon must be between 0 and 1");
+        }
+    }
+    bool next() {
+        accumulated += step;
+        if (accumulated >= ONE) {
+            accumulated -= ONE;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    static constexpr uint64_t ONE = uint64_t{1} << 32;
+
+    uint64_t step;
+    uint64_t accumulated{0};
+};
+
+// LRU insertion (Qureshi et al.): fills enter at the LRU position and are
+// promoted only on a hit, so a working set larger than the cache keeps
+// part of itself instead of thrashing
+template <typename Order>
+class LipPolicy {
+public:
+    LipPolicy(int ways, const PolicyOptions&) : order(ways) {}
+    void onHit(size_t way, const AccessInfo&) { order.promote(way); }
+    void onFill(size_t way, const AccessInfo&) { order.demote(way); }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) const { return order.victim(); }
+
+private:
+    Order order;
+};
+
+// Bimodal insertion: like LIP, but an epsilon fraction of fills enter at
+// MRU, so the cache still follows a working set that changes
+template <typename Order>
+class BipPolicy {
+public:
+    BipPolicy(int ways, const PolicyOptions& options)
+        : order(ways), bimodal(options.bimodalEpsilon) {}
+    void onHit(size_t way, const AccessInfo&) { order.promote(way); }
+    void onFill(size_t way, const AccessInfo&) {
+        if (bimodal.next()) {
+            order.promote(way);
+        } else {
+            order.demote(way);
+        }
+    }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) const { return order.victim(); }
+
+private:
+    Order order;
+    BimodalChoice bimodal;
+};
+
+// Dynamic insertion: MRU-inserting and BIP leader sets duel, and follower
+// sets insert as the side that is missing less
+template <typename Order>
+class DipPolicy {
+public:
+    using Shared = SetDuel;
+
+    DipPolicy(int ways, const PolicyOptions& options, SetDuel& duel, size_t set)
+        : order(ways), bimodal(options.bimodalEpsilon), duel(&duel), role(duel.role(set)) {}
+    void onHit(size_t way, const AccessInfo&) { order.promote(way); }
+    void onFill(size_t way, const AccessInfo&) {
+        duel->recordMiss(role);
+        if (duel->useB(role) && !bimodal.next()) {
+            order.demote(way);
+        } else {
+            order.promote(way);
+        }
+    }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) const { return order.victim(); }
+
+private:
+    Order order;
+    BimodalChoice bimodal;
+    SetDuel* duel;
+    SetDuel::Role role;
+};
+
+// Least frequently used, ties to the least recently touched. Each line
+// has a saturating use count; lines with equal counts share a bucket, and
+// buckets form a list in increasing count, so a hit moves its line to the
+// next bucket and the victim heads the first bucket, both in O(1). With
+// aging, every lfuAgingPeriod accesses to the set halve all counts
+// (rounding up), so old popularity fades; buckets that meet are merged by
+// last use, keeping ties least recently touched first.
+class LfuPolicy {
+public:
+    static constexpr uint8_t MAX_COUNT = 255;
+
+    LfuPolicy(int ways, const PolicyOptions& options)
+        : lines(ways), buckets(ways), agingPeriod(options.lfuAgingPeriod) {
+        if (ways < 1 || ways >= NONE) {
+            throw std::invalid_argument("LFU supports up to 65534 ways");
+        }
+        for (int b = 0; b < ways; ++b) {
+            buckets[b].next = static_cast<uint16_t>(b + 1 < ways ? b + 1 : NONE);
+        }
+        freeBucket = 0;
+    }
+
+    void onHit(size_t way, const AccessInfo&) {
+        promote(static_cast<uint16_t>(way));
+        lines[way].lastUse = ++clock;
+        age();
+    }
+    void onFill(size_t way, const AccessInfo&) {
+        uint16_t target = first;
+        if (target == NONE || buckets[target].count != 1) {
+            target = newBucket(NONE, 1);
+        }
+        append(static_cast<uint16_t>(way), target);
+        lines[way].lastUse = ++clock;
+        age();
+    }
+    void onEvict(size_t way) { detach(static_cast<uint16_t>(way)); }
+    size_t victim(const AccessInfo&) const { return buckets[first].head; }
+
+private:
+    static constexpr uint16_t NONE = UINT16_MAX;
+
+    struct Line {
+        uint16_t bucket{NONE};
+        uint16_t prev{NONE};
+        uint16_t next{NONE};
+        uint64_t lastUse{0};
+    };
+    struct Bucket {
+        uint8_t count{0};
+        uint16_t head{NONE};
+        uint16_t tail{NONE};
+        uint16_t prev{NONE};
+        uint16_t next{NONE};
+    };
+
+    std::vector<Line> lines;
+    std::vector<Bucket> buckets;   // in use from `first`, the rest on a free list
+    uint16_t first{NONE};
+    uint16_t freeBucket{NONE};
+    uint32_t agingPeriod;
+    uint32_t sinceAging{0};
+    uint64_t clock{0};
+
+    // Take a bucket off the free list and link it after `prev` (NONE: first)
+    uint16_t newBucket(uint16_t prev, uint8_t count) {
+        uint16_t b = freeBucket;
+        freeBucket = buckets[b].next;
+        uint16_t next = prev == NONE ? first : buckets[prev].next;
+        buckets[b] = {count, NONE, NONE, prev, next};
+        (prev == NONE ? first : buckets[prev].next) = b;
+        if (next != NONE) {
+            buckets[next].prev = b;
+        }
+        return b;
+    }
+
+    void freeIfEmpty(uint16_t b) {
+        if (buckets[b].head != NONE) {
+            return;
+        }
+        Bucket& bucket = buckets[b];
+        (bucket.prev == NONE ? first : buckets[bucket.prev].next) = bucket.next;
+        if (bucket.next != NONE) {
+            buckets[bucket.next].prev = bucket.prev;
+        }
+        bucket.next = freeBucket;
+        freeBucket = b;
+    }
+
+    void append(uint16_t way, uint16_t b) {
+        Line& line = lines[way];
+        line = {b, buckets[b].tail, NONE, line.lastUse};
+        (buckets[b].tail == NONE ? buckets[b].head : lines[buckets[b].tail].next) = way;
+        buckets[b].tail = way;
+    }
+
+    void unlink(uint16_t way) {
+        Line& line = lines[way];
+        Bucket& bucket = buckets[line.bucket];
+        (line.prev == NONE ? bucket.head : lines[line.prev].next) = line.next;
+        (line.next == NONE ? bucket.tail : lines[line.next].prev) = line.prev;
+    }
+
+    void detach(uint16_t way) {
+        unlink(way);
+        freeIfEmpty(lines[way].bucket);
+    }
+
+    void promote(uint16_t way) {
+        uint16_t b = lines[way].bucket;
+        uint8_t count = buckets[b].count;
+        uint16_t next = buckets[b].next;
+        if (count == MAX_COUNT) {
+            // Saturated: only refresh recency within the bucket
+            if (buckets[b].tail != way) {
+                unlink(way);
+                append(way, b);
+            }
+            return;
+        }
+        if (next != NONE && buckets[next].count == count + 1) {
+            detach(way);
+            append(way, next);
+        } else if (buckets[b].head == way && buckets[b].tail == way) {
+            buckets[b].count++;
+        } else {
+            uint16_t target = newBucket(b, static_cast<uint8_t>(count + 1));
+            detach(way);
+            append(way, target);
+        }
+    }
+
+    void age() {
+        if (agingPeriod == 0 || ++sinceAging < agingPeriod) {
+            return;
+        }
+        sinceAging = 0;
+        for (uint16_t b = first; b != NONE;) {
+            uint16_t next = buckets[b].next;
+            buckets[b].count = static_cast<uint8_t>((buckets[b].count + 1) / 2);
+            uint16_t prev = buckets[b].prev;
+            if (prev != NONE && buckets[prev].count == buckets[b].count) {
+                merge(prev, b);
+            }
+            b = next;
+        }
+    }
+
+    // Move bucket b's lines into `into`; both lists run from least to most
+    // recently used, and so does the merged one
+    void merge(uint16_t into, uint16_t b) {
+        uint16_t left = buckets[into].head;
+        uint16_t right = buckets[b].head;
+        uint16_t tail = NONE;
+        while (left != NONE || right != NONE) {
+            uint16_t way;
+            if (right == NONE || (left != NONE && lines[left].lastUse < lines[right].lastUse)) {
+                way = left;
+                left = lines[left].next;
+            } else {
+                way = right;
+                right = lines[right].next;
+            }
+            lines[way].bucket = into;
+            lines[way].prev = tail;
+            (tail == NONE ? buckets[into].head : lines[tail].next) = way;
+            tail = way;
+        }
+        lines[tail].next = NONE;
+        buckets[into].tail = tail;
+        buckets[b].head = NONE;
+        freeIfEmpty(b);
+    }
+};
+
+// Adaptive Replacement Cache (Megiddo and Modha) within one set of c ways.
+// T1 holds lines referenced once since they were filled and T2 lines
+// referenced again; ghost lists B1 and B2 keep the tags last evicted from
+// each. A miss on a B1 ghost grows the target size p of T1, one on a B2
+// ghost shrinks it, and the victim comes from T1 while T1 is above target,
+// otherwise from T2. Lists are per-entry ids with recency stamps. A miss
+// in a full set scans the ghosts once for the incoming tag, the resident
+// ways once for the victim, and the ghosts once more only when one must be
+// dropped; free ghost slots are kept on a stack.
+class ArcPolicy {
+public:
+    ArcPolicy(int ways, const PolicyOptions&)
+        : capacity(static_cast<uint32_t>(ways)),
+          residentList(ways, NONE), residentTag(ways, 0), residentStamp(ways, 0),
+          ghostList(2 * ways, NONE), ghostTag(2 * ways, 0), ghostStamp(2 * ways, 0) {
+        freeGhosts.reserve(2 * ways);
+        for (size_t slot = 2 * ways; slot-- > 0;) {
+            freeGhosts.push_back(static_cast<uint32_t>(slot));
+        }
+    }
+
+    void onHit(size_t way, const AccessInfo&) {
+        if (residentList[way] == T1) {
+            residentList[way] = T2;
+            size[T1]--;
+            size[T2]++;
+        }
+        residentStamp[way] = ++clock;
+    }
+
+    void onFill(size_t way, const AccessInfo& info) {
+        uint8_t list = T1;
+        // A fill after victim() reuses its lookup; an empty set has no ghosts
+        size_t ghost = std::exchange(victimGhost, NOT_FOUND);
+        if (ghost != NOT_FOUND) {
+            releaseGhost(ghost);
+            list = T2;
+        }
+        residentList[way] = list;
+        residentTag[way] = info.tag;
+        residentStamp[way] = ++clock;
+        size[list]++;
+    }
+
+    void onEvict(size_t way) {
+        uint8_t list = residentList[way];
+        residentList[way] = NONE;
+        size[list]--;
+        if (dropEvicted) {
+            dropEvicted = false;
+            return;
+        }
+        if (freeGhosts.empty()) {
+            throw std::logic_error("ARC ghost lists overflowed");
+        }
+        size_t slot = freeGhosts.back();
+        freeGhosts.pop_back();
+        ghostList[slot] = list == T1 ? B1 : B2;
+        ghostTag[slot] = residentTag[way];
+        ghostStamp[slot] = ++clock;
+        size[ghostList[slot]]++;
+    }
+
+    size_t victim(const AccessInfo& info) {
+        size_t ghost = findGhost(info.tag);
+        victimGhost = ghost;
+        uint8_t ghostHit = ghost == NOT_FOUND ? NONE : ghostList[ghost];
+        if (ghostHit == B1) {
+            target = std::min(capacity, target + std::max<uint32_t>(size[B2] / size[B1], 1));
+        } else if (ghostHit == B2) {
+            uint32_t delta = std::max<uint32_t>(size[B1] / size[B2], 1);
+            target = target > delta ? target - delta : 0;
+        } else if (size[T1] + size[B1] == capacity) {
+            if (size[T1] == capacity) {
+                // B1 is empty: drop T1's oldest line without a ghost
+                dropEvicted = true;
+                return oldest(residentList, residentStamp, T1);
+            }
+            dropGhost(B1);
+        } else if (size[T1] + size[T2] + size[B1] + size[B2] == 2 * capacity) {
+            dropGhost(B2);
+        }
+
+        bool fromT1 = size[T1] > 0 &&
+                      (size[T1] > target || (ghostHit == B2 && size[T1] == target));
+        if (size[fromT1 ? T1 : T2] == 0) {
+            fromT1 = !fromT1;
+        }
+        return oldest(residentList, residentStamp, fromT1 ? T1 : T2);
+    }
+
+private:
+    static constexpr uint8_t T1 = 0, T2 = 1, B1 = 2, B2 = 3, NONE = 4;
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+    uint32_t capacity;
+    uint32_t target{0};
+    uint32_t size[5]{};
+    uint64_t clock{0};
+    bool dropEvicted{false};
+    std::vector<uint8_t> residentList;
+    std::vector<uint64_t> residentTag;
+    std::vector<uint64_t> residentStamp;
+    std::vector<uint8_t> ghostList;
+    std::vector<uint64_t> ghostTag;
+    std::vector<uint64_t> ghostStamp;
+    std::vector<uint32_t> freeGhosts;
+    size_t victimGhost{NOT_FOUND};   // the incoming tag's ghost, from victim()
+
+    static size_t oldest(const std::vector<uint8_t>& lists, const std::vector<uint64_t>& stamps,
+                         uint8_t list) {
+        size_t found = NOT_FOUND;
+        for (size_t i = 0; i < lists.size(); ++i) {
+            if (lists[i] == list && (found == NOT_FOUND || stamps[i] < stamps[found])) {
+                found = i;
+            }
+        }
+        return found;
+    }
+
+    size_t findGhost(uint64_t tag) const {
+        for (size_t i = 0; i < ghostList.size(); ++i) {
+            if (ghostList[i] != NONE && ghostTag[i] == tag) {
+                return i;
+            }
+        }
+        return NOT_FOUND;
+    }
+
+    void releaseGhost(size_t slot) {
+        size[ghostList[slot]]--;
+        ghostList[slot] = NONE;
+        freeGhosts.push_back(static_cast<uint32_t>(slot));
+    }
+
+    void dropGhost(uint8_t list) {
+        releaseGhost(oldest(ghostList, ghostStamp, list));
+    }
+};
+
+// M-bit re-reference prediction values (RRPVs) of up to 64 ways, stored as
+// M bit planes: plane k holds bit k of every way's RRPV. Finding the ways
+// with the largest RRPV and aging every way are then a few word-wide
+// operations per bit instead of a loop over the ways.
+class RripValues {
+public:
+    static constexpr int MAX_BITS = 8;
+
+    RripValues(int ways, int bits)
+        : validMask(ways >= 64 ? ~uint64_t{0} : (uint64_t{1} << ways) - 1), bits(bits) {
+        if (ways < 1 || ways > 64) {
+            throw std::invalid_argument("RRIP policies support up to 64 ways");
+        }
+        if (bits < 1 || bits > MAX_BITS) {
+            throw std::invalid_argument("RRPVs must have between 1 and 8 bits");
+        }
+    }
+
+    [[nodiscard]] uint32_t distant() const { return (uint32_t{1} << bits) - 1; }
+
+    void set(size_t way, uint32_t value) {
+        uint64_t mask = uint64_t{1} << way;
+        for (int k = 0; k < bits; ++k) {
+            uint64_t want = uint64_t{0} - ((value >> k) & 1);
+            planes[k] ^= (planes[k] ^ want) & mask;
+        }
+    }
+
+    // Age every way until the oldest reach the distant RRPV, as repeated
+    // increments would, and return the lowest of them
+    size_t victim() {
+        uint64_t oldest = validMask;
+        uint32_t largest = 0;
+        for (int k = bits - 1; k >= 0; --k) {
+            uint64_t withBit = oldest & planes[k];
+            uint64_t keep = uint64_t{0} - static_cast<uint64_t>(withBit != 0);
+            oldest = (withBit & keep) | (oldest & ~keep);
+            largest |= static_cast<uint32_t>(withBit != 0) << k;
+        }
+        add(distant() - largest);
+        return static_cast<size_t>(std::countr_zero(oldest));
+    }
+
+private:
+    std::array<uint64_t, MAX_BITS> planes{};
+    uint64_t validMask;
+    int bits;
+
+    // Bit-sliced ripple-carry addition of one constant to every way's RRPV
+    void add(uint32_t delta) {
+        uint64_t carry = 0;
+        for (int k = 0; k < bits; ++k) {
+            uint64_t addend = uint64_t{0} - ((delta >> k) & 1);
+            uint64_t plane = planes[k];
+            planes[k] = (plane ^ addend ^ carry) & validMask;
+            carry = (plane & addend) | (carry & (plane ^ addend));
+        }
+    }
+};
+
+// Fills that BRRIP inserts at the long rather than distant RRPV: one in this many
+constexpr uint32_t BRRIP_LONG_PERIOD = 32;
+
+// Static RRIP (Jaleel et al.), hit priority: hits predict a near-immediate
+// re-reference, fills a long one, and the victim has the distant RRPV
+class SrripPolicy {
+public:
+    SrripPolicy(int ways, const PolicyOptions& options) : rrpv(ways, options.rripBits) {}
+    void onHit(size_t way, const AccessInfo&) { rrpv.set(way, 0); }
+    void onFill(size_t way, const AccessInfo&) { rrpv.set(way, rrpv.distant() - 1); }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) { return rrpv.victim(); }
+
+private:
+    RripValues rrpv;
+};
+
+// Bimodal RRIP: fills mostly predict a distant re-reference, so a scan
+// cannot flush the set, and occasionally a long one
+class BrripPolicy {
+public:
+    BrripPolicy(int ways, const PolicyOptions& options) : rrpv(ways, options.rripBits) {}
+    void onHit(size_t way, const AccessInfo&) { rrpv.set(way, 0); }
+    void onFill(size_t way, const AccessInfo&) {
+        rrpv.set(way, fills++ % BRRIP_LONG_PERIOD == 0 ? rrpv.distant() - 1 : rrpv.distant());
+    }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) { return rrpv.victim(); }
+
+private:
+    RripValues rrpv;
+    uint32_t fills{0};
+};
+
+// Dynamic RRIP: SRRIP and BRRIP leader sets duel, and follower sets insert
+// as the side that is missing less
+class DrripPolicy {
+public:
+    using Shared = SetDuel;
+
+    DrripPolicy(int ways, const PolicyOptions& options, SetDuel& duel, size_t set)
+        : rrpv(ways, options.rripBits), duel(&duel), role(duel.role(set)) {}
+    void onHit(size_t way, const AccessInfo&) { rrpv.set(way, 0); }
+    void onFill(size_t way, const AccessInfo&) {
+        duel->recordMiss(role);
+        bool distant = duel->useB(role) && fills++ % BRRIP_LONG_PERIOD != 0;
+        rrpv.set(way, distant ? rrpv.distant() : rrpv.distant() - 1);
+    }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) { return rrpv.victim(); }
+
+private:
+    RripValues rrpv;
+    SetDuel* duel;
+    SetDuel::Role role;
+    uint32_t fills{0};
+};
+
+// SHiP (Wu et al.) over SRRIP: lines filled by a PC signature whose lines
+// tend to die unreused are inserted at the distant RRPV, the rest at long
+class ShipPolicy {
+public:
+    using Shared = ShipTable;
+    static constexpr bool needsPc = true;
+
+    ShipPolicy(int ways, const PolicyOptions& options, ShipTable& table, size_t)
+        : rrpv(ways, options.rripBits), signatures(ways, 0), table(&table) {}
+    void onHit(size_t way, const AccessInfo&) {
+        rrpv.set(way, 0);
+        reused |= uint64_t{1} << way;
+        table->recordReuse(signatures[way]);
+    }
+    void onFill(size_t way, const AccessInfo& info) {
+        uint32_t signature = table->signature(info.pc);
+        signatures[way] = static_cast<uint16_t>(signature);
+        reused &= ~(uint64_t{1} << way);
+        rrpv.set(way, table->predictsReuse(signature) ? rrpv.distant() - 1 : rrpv.distant());
+    }
+    void onEvict(size_t way) {
+        if (!(reused >> way & 1)) {
+            table->recordDead(signatures[way]);
+        }
+    }
+    size_t victim(const AccessInfo&) { return rrpv.victim(); }
+
+private:
+    RripValues rrpv;
+    std::vector<uint16_t> signatures;   // signature of the PC that filled each way
+    uint64_t reused{0};                 // ways hit since their fill
+    ShipTable* table;
+};
+
+// Hawkeye (Jain and Lin): sampled sets replay OPT with OPTgen to learn which
+// PCs load lines OPT would keep. Lines from those cache-friendly PCs get
+// RRPV 0, the rest the highest RRPV so they go first.
+class HawkeyePolicy {
+public:
+    using Shared = HawkeyePredictor;
+    static constexpr bool needsPc = true;
+    static constexpr uint8_t MAX_RRPV = 7;
+
+    HawkeyePolicy(int ways, const PolicyOptions&, HawkeyePredictor& predictor, size_t set)
+        : rrpv(ways, MAX_RRPV), signatures(ways, 0), predictor(&predictor) {
+        if (predictor.isSampled(set)) {
+            optgen = std::make_unique<OptGen>(ways);
+        }
+    }
+    void onHit(size_t way, const AccessInfo& info) {
+        uint32_t signature = train(info);
+        signatures[way] = static_cast<uint16_t>(signature);
+        rrpv[way] = predictor->isFriendly(signature) ? 0 : MAX_RRPV;
+    }
+    void onFill(size_t way, const AccessInfo& info) {
+        uint32_t signature = train(info);
+        signatures[way] = static_cast<uint16_t>(signature);
+        if (!predictor->isFriendly(signature)) {
+            rrpv[way] = MAX_RRPV;
+            return;
+        }
+        // Age the other friendly lines, keeping them below the averse ones
+        for (uint8_t& value : rrpv) {
+            if (value < MAX_RRPV - 1) {
+                value++;
+            }
+        }
+        rrpv[way] = 0;
+    }
+    void onEvict(size_t) {}
+
+    // A cache-averse line if there is one; otherwise the oldest friendly
+    // line, whose PC was wrong to call it friendly
+    size_t victim(const AccessInfo&) {
+        auto oldest = std::max_element(rrpv.begin(), rrpv.end());
+        size_t way = static_cast<size_t>(oldest - rrpv.begin());
+        if (*oldest != MAX_RRPV) {
+            predictor->train(signatures[way], false);
+        }
+        return way;
+    }
+
+private:
+    std::vector<uint8_t> rrpv;
+    std::vector<uint16_t> signatures;   // signature of the PC that last touched each way
+    std::unique_ptr<OptGen> optgen;     // sampled sets only
+    HawkeyePredictor* predictor;
+
+    // Feed a sampled set's access to OPTgen, train the predictor on the
+    // PC that last touched the block, and return this access's signature
+    uint32_t train(const AccessInfo& info) {
+        uint32_t signature = predictor->signature(info.pc);
+        if (optgen) {
+            OptGen::Verdict verdict = optgen->access(info.tag, signature);
+            if (verdict.reuse) {
+                predictor->train(verdict.signature, verdict.optHit);
+            }
+        }
+        return signature;
+    }
+};
+
+// A policy from a shared object named with -p plugin:PATH. Hooks become
+// batched events for the library; see PluginSets.
+class PluginPolicy {
+public:
+    using Shared = PluginSets;
+
+    PluginPolicy(int ways, const PolicyOptions&, PluginSets& sets, size_t set)
+        : sets(&sets), set(set) {
+        sets.attach(ways);
+    }
+    void onHit(size_t way, const AccessInfo& info) {
+        sets->record(CACHESIM_HIT, set, way, info.tag, info.pc);
+    }
+    void onFill(size_t way, const AccessInfo& info) {
+        sets->record(CACHESIM_FILL, set, way, info.tag, info.pc);
+    }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo& info) { return sets->victim(set, info.tag, info.pc); }
+
+private:
+    PluginSets* sets;
+    size_t set;
+};
+
+// Evict a uniformly random way. Each set draws from its own xorshift64
+// stream, started from the seed and the set's index, so a run is
+// reproducible and a set's choices do not depend on the other sets,
+// sharded or not.
+class RandomPolicy {
+public:
+    RandomPolicy(int ways, const PolicyOptions& options, size_t set)
+        : state(seedState(options.randomSeed, set)), ways(static_cast<uint64_t>(ways)) {}
+    void onHit(size_t, const AccessInfo&) {}
+    void onFill(size_t, const AccessInfo&) {}
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Scale the high 32 bits to [0, ways) without a division
+        return static_cast<size_t>(((state >> 32) * ways) >> 32);
+    }
+
+private:
+    uint64_t state;
+    uint64_t ways;
+
+    // Output set + 1 of SplitMix64 started at the seed, so neighbouring sets
+    // and nearby seeds give unrelated streams; never zero, since xorshift
+    // would stay there
+    static uint64_t seedState(uint64_t seed, size_t set) {
+        uint64_t z = seed + (static_cast<uint64_t>(set) + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        return z != 0 ? z : 1;
+    }
+};
+
+// Belady's MIN: evict the way whose block is referenced furthest ahead
+class OptimalPolicy {
+public:
+    static constexpr bool needsNextUse = true;
+
+    OptimalPolicy(int ways, const PolicyOptions&) : nextUse(ways, 0) {}
+    void onHit(size_t way, const AccessInfo& info) { nextUse[way] = info.nextUse; }
+    void onFill(size_t way, const AccessInfo& info) { nextUse[way] = info.nextUse; }
+    void onEvict(size_t) {}
+    size_t victim(const AccessInfo&) const {
+        size_t furthest = 0;
+        for (size_t way = 1; way < nextUse.size(); ++way) {
+            if (nextUse[way] > nextUse[furthest]) {
+                furthest = way;
+            }
+        }
+        return furthest;
+    }
+
+private:
+    std::vector<uint64_t> nextUse;
+};
+
+template <typename P>
+struct PolicyType {
+    using type = P;
+};
+
+// The one place a runtime policy choice becomes a type: calls
+// f(PolicyType<P>{}) so everything f instantiates inlines the policy
+template <typename F>
+decltype(auto) withPolicy(ReplacementPolicy policy, F&& f) {
+    switch (policy) {
+        case ReplacementPolicy::LRU:     return f(PolicyType<LruPolicy>{});
+        case ReplacementPolicy::MRU:     return f(PolicyType<MruPolicy>{});
+        case ReplacementPolicy::FIFO:    return f(PolicyType<FifoPolicy>{});
+        case ReplacementPolicy::PLRU:    return f(PolicyType<PlruPolicy>{});
+        case ReplacementPolicy::LFU:     return f(PolicyType<LfuPolicy>{});
+        case ReplacementPolicy::ARC:     return f(PolicyType<ArcPolicy>{});
+        case ReplacementPolicy::SRRIP:   return f(PolicyType<SrripPolicy>{});
+        case ReplacementPolicy::BRRIP:   return f(PolicyType<BrripPolicy>{});
+        case ReplacementPolicy::DRRIP:   return f(PolicyType<DrripPolicy>{});
+        case ReplacementPolicy::SHIP:    return f(PolicyType<ShipPolicy>{});
+        case ReplacementPolicy::HAWKEYE: return f(PolicyType<HawkeyePolicy>{});
+        case ReplacementPolicy::LIP:     return f(PolicyType<LipPolicy<LruStamps>>{});
+        case ReplacementPolicy::BIP:     return f(PolicyType<BipPolicy<LruStamps>>{});
+        case ReplacementPolicy::DIP:     return f(PolicyType<DipPolicy<LruStamps>>{});
+        case ReplacementPolicy::LIP_PLRU: return f(PolicyType<LipPolicy<PlruTree>>{});
+        case ReplacementPolicy::BIP_PLRU: return f(PolicyType<BipPolicy<PlruTree>>{});
+        case ReplacementPolicy::DIP_PLRU: return f(PolicyType<DipPolicy<PlruTree>>{});
+        case ReplacementPolicy::PLUGIN:  return f(PolicyType<PluginPolicy>{});
+        case ReplacementPolicy::RANDOM:  return f(PolicyType<RandomPolicy>{});
+        case ReplacementPolicy::OPTIMAL: return f(PolicyType<OptimalPolicy>{});
+    }
+    throw std::invalid_argument("Unknown replacement policy");
+}
+
+// Whether a policy's sets share state, so a cache under it cannot be split
+// into independently simulated groups of sets
+inline bool policySharesState(ReplacementPolicy policy) {
+    return withPolicy(policy, [](auto type) {
+        return SharedStatePolicy<typename decltype(type)::type>;
+    });
+}
+
+// Whether a policy needs the PC of every access, which only the modes that
+// stream PC-tagged traces provide
+inline bool policyNeedsPc(ReplacementPolicy policy) {
+    return withPolicy(policy, [](auto type) {
+        return policyNeedsPc<typename decltype(type)::type>();
+    });
+}
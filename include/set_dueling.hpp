@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "policies.hpp"
+
+// Set dueling (Qureshi et al.) between two policies A and B. A few leader
+// sets always run A or always run B; misses in them steer a saturating PSEL
+// counter, and every other set follows whichever side is missing less.
+// Adaptive policies hold one per cache as their shared state.
+class SetDuel {
+public:
+    enum class Role : uint8_t { FOLLOWER, LEADER_A, LEADER_B };
+
+    // options.duelLeaders leader sets per side, capped at numSets / 4 so half
+    // the sets or more follow, spread evenly over the index space, and an
+    // options.pselBits-bit PSEL starting at its midpoint
+    SetDuel(size_t numSets, const PolicyOptions& options);
+
+    [[nodiscard]] Role role(size_t set) const;
+
+    void recordMiss(Role role) {
+        if (role == Role::LEADER_A && psel < pselMax) {
+            psel++;
+        } else if (role == Role::LEADER_B && psel > 0) {
+            psel--;
+        }
+    }
+
+    // Whether a set in this role runs policy B now; ties go to A
+    [[nodiscard]] bool useB(Role role) const {
+        return role == Role::LEADER_B || (role == Role::FOLLOWER && psel > midpoint);
+    }
+
+private:
+    size_t stride{0};   // sets per constituency, one leader of each side in each
+    uint32_t pselMax;
+    uint32_t midpoint;
+    uint32_t psel;
+};
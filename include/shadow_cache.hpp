@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Fully-associative LRU cache of block addresses used to split misses into
+// capacity and conflict misses. Recency is an intrusive doubly linked list
+// over a fixed node pool, so hits and fills are O(1) without allocation.
+class ShadowLRU {
+public:
+    explicit ShadowLRU(size_t capacity);
+
+    // Returns true on a hit; either way the block ends up most recently used
+    bool access(uint64_t block);
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        uint64_t block;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    const size_t capacity;
+    std::vector<Node> nodes;
+    uint32_t head{NONE};   // most recently used
+    uint32_t tail{NONE};   // least recently used
+    std::unordered_map<uint64_t, uint32_t> index;
+
+    void unlink(uint32_t node);
+    void pushFront(uint32_t node);
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free ring for exactly one producer thread and one consumer
+// thread. Each side caches the other's index and only rereads it when the
+// ring looks full or empty, so the shared cache lines move once per burst
+// rather than once per item. A full or empty side spins briefly, then yields.
+template <typename T>
+class SpscRing {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) : slots(roundUp(capacity)), mask(slots.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side; false once the ring has been cancelled
+    bool push(T item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        unsigned spins = 0;
+        while (t - cachedHead == slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead < slots.size()) {
+                break;
+            }
+            if (cancelled.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            backoff(spins);
+        }
+        slots[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false once the ring is closed and drained, or cancelled
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        unsigned spins = 0;
+        while (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h != cachedTail) {
+                break;
+            }
+            if (closed.load(std::memory_order_acquire)) {
+                // Items pushed before close() are visible now
+                cachedTail = tail.load(std::memory_order_acquire);
+                if (h == cachedTail) {
+                    return false;
+                }
+                break;
+            }
+            if (cancelled.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            backoff(spins);
+        }
+        item = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer: no more items will be pushed
+    void close() { closed.store(true, std::memory_order_release); }
+
+    // Either side: abandon the stream, releasing a blocked peer
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+private:
+    std::vector<T> slots;
+    const size_t mask;
+
+    // Consumer-owned line
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail{0};
+
+    // Producer-owned line
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead{0};
+
+    alignas(64) std::atomic<bool> closed{false};
+    std::atomic<bool> cancelled{false};
+
+    static size_t roundUp(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    static void backoff(unsigned& spins) {
+        if (++spins < 64) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+};
@@ -41,6 +41,12 @@ public:
 
     // Record cache access
     void recordAccess(bool isHit, bool isCold = false, bool isConflict = false) {
+        recordOutcome(isHit, isCold, isConflict);
+        hitRateHistory.push_back(getHitRate());
+    }
+
+    // Update counters only, without per-access history
+    void recordOutcome(bool isHit, bool isCold = false, bool isConflict = false) {
         totalAccesses++;
         
         if (isHit) {
@@ -51,8 +57,6 @@ public:
             else if (isConflict) conflictMisses++;
             else capacityMisses++;
         }
-        
-        hitRateHistory.push_back(getHitRate());
     }
 
     // Reset statistics
@@ -68,4 +72,15 @@ public:
         totalAccessTime = std::chrono::microseconds(0);
         policy = ReplacementPolicy::LRU;  // Reset to default
     }
-};
\ No newline at end of file
+};
+
+// Whole-cache results estimated from a hashed sample of sets
+struct SetSampleEstimate {
+    uint64_t sampledSets{0};
+    uint64_t totalSets{0};
+    uint64_t sampledAccesses{0};
+    uint64_t totalAccesses{0};
+    double scale{1.0};          // total / sampled accesses
+    double hitRate{0};          // percent
+    double marginOfError{0};    // 95% confidence half-width, percent (NaN if unknown)
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "policies.hpp"
+#include "stats.hpp"
+
+// One point of a parameter sweep
+struct SweepConfig {
+    int blockSize;
+    int numSets;
+    int ways;
+    ReplacementPolicy policy;
+};
+
+struct SweepResult {
+    SweepConfig config;
+    CacheStats stats;
+};
+
+// Expand a grid such as "B=16,64;I=256,1024;w=1,2,4;p=lru,fifo" into every
+// combination. Keys left out take their value from `defaults`.
+std::vector<SweepConfig> parseSweepSpec(const std::string& spec, const SweepConfig& defaults);
+
+// Simulate every configuration over one shared in-memory trace on a
+// work-stealing thread pool; results keep grid order. Direct-mapped and
+// 2-way LRU/MRU configurations of a block size run eight at a time on a
+// LaneSimulator. Other non-OPT configurations with enough sets are split
+// into per-set shards so one large job cannot hold up the tail of the sweep.
+std::vector<SweepResult> runSweep(int N, const std::vector<SweepConfig>& grid,
+                                  const std::vector<uint64_t>& trace, int threads,
+                                  const PolicyOptions& options = {});
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads with work stealing.
+//
+// Every worker owns a deque: it runs its own tasks newest first and, once
+// that runs dry, steals the oldest task from another worker. Tasks submitted
+// from outside the pool are dealt round-robin across the deques; tasks a
+// running task submits go to its own worker's deque, so a job can split
+// itself into pieces that idle workers pick up.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished, including tasks that
+    // tasks submitted; rethrows the first exception a task raised
+    void wait();
+
+    [[nodiscard]] int size() const { return static_cast<int>(workers.size()); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue{0};
+
+    // Guards the counters below; queued counts tasks not yet claimed
+    std::mutex mutex;
+    std::condition_variable taskReady;
+    std::condition_variable allDone;
+    size_t queued{0};
+    size_t pending{0};
+    bool stopping{false};
+    std::exception_ptr firstError;
+
+    bool takeTask(int worker, std::function<void()>& task);
+    void workerLoop(int worker);
+};
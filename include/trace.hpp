@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Parse one trace line ("x1F", "0x1F" or "1F") into an address
+uint64_t parseHexAddress(const std::string& text);
+
+// One trace line with the instruction that made the access, for PC-aware
+// policies. pc is 0 on lines that do not name one.
+struct TraceAccess {
+    uint64_t address;
+    uint64_t pc;
+};
+
+// Streams a trace file one address at a time so analysis modes never
+// need to hold the whole trace in memory. Every non-empty line is an access.
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& filename);
+    bool next(uint64_t& address);
+
+    // Timestamped traces carry a decimal time after the address ("0x1F 1200")
+    bool next(uint64_t& address, uint64_t& timestamp);
+
+    // PC-tagged traces carry the PC as a second, 0x- or x-prefixed hex field
+    // ("0x1F 0x400A10"), which may be followed by a timestamp
+    bool next(TraceAccess& access);
+
+    // Make next(TraceAccess&) throw on a line without a PC, naming the
+    // policy that needs one
+    void requirePc(const std::string& policyName);
+
+private:
+    std::ifstream file;
+    std::string line;
+    std::string pcRequiredBy;
+};
+
+// Read a whole trace into memory as numeric addresses, and the PC of each
+// access into pcs when given; a non-empty pcRequiredBy rejects lines without
+// a PC as TraceReader::requirePc does
+std::vector<uint64_t> loadTrace(const std::string& filename, std::vector<uint64_t>* pcs = nullptr,
+                                const std::string& pcRequiredBy = "");
+
+// Expand shell-style patterns ("traces/*.txt") into sorted file names;
+// arguments without wildcards are kept as given
+std::vector<std::string> expandTraceFiles(const std::vector<std::string>& patterns);
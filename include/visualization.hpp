@@ -2,19 +2,70 @@
 #define VISUALIZATION_HPP
 
 #include "cache.hpp"
+#include "all_assoc.hpp"
+#include "mrc.hpp"
+#include "sweep.hpp"
+#include "batch.hpp"
+#include "policy_compare.hpp"
+#include "multicore.hpp"
+#include <ostream>
 #include <vector>
 #include <string>
+#include <utility>
 
 class CacheVisualizer {
 public:
+    // Column widths of the per-access table
+    struct TableLayout {
+        size_t addrWidth;
+        size_t tagWidth;
+        size_t indexWidth;
+        size_t offsetWidth;
+        size_t hmWidth;
+        size_t replWidth;
+    };
+
     static void printResults(
         const std::vector<Cache::AccessResult>& results,
         const CacheStats& stats);
 
+    // Widths fitted to a finished run, or fixed from the cache geometry so
+    // rows can be printed while the trace is still being simulated
+    static TableLayout tableLayout(const std::vector<Cache::AccessResult>& results);
+    static TableLayout tableLayout(const Cache& cache);
+    static void printTableHeader(std::ostream& out, const CacheStats& stats, const TableLayout& layout);
+    static void printTableRow(std::ostream& out, const Cache::AccessResult& result,
+                              const TableLayout& layout);
+
+    // Configuration and statistics without the per-access table
+    static void printSummary(const CacheStats& stats);
+    static void printStatistics(const CacheStats& stats);
+
     static void generateVisualization(
         const std::vector<Cache::AccessResult>& results,
         const CacheStats& stats,
         const std::string& outputFile);
+
+    static void printSetSampleEstimate(const CacheStats& stats, const SetSampleEstimate& estimate);
+
+    static void printSweepResults(const std::vector<SweepResult>& results);
+
+    // One column per policy, one row per statistic
+    static void printPolicyComparison(const PolicyComparison& comparison);
+
+    // Per-file rows of a batch run followed by totals over the files that loaded
+    static void printBatchResults(const std::vector<BatchResult>& results);
+
+    // One row per core's private cache, then the shared cache they feed
+    static void printMultiCoreResults(const MultiCoreSimulator& sim);
+
+    static void printAllAssociativity(const AllAssociativitySimulator& sim);
+
+    static void printMissRatioCurve(const std::string& title, const MissRatioCurve& curve);
+
+    static void printMissRatioCurves(
+        const std::string& title,
+        const std::vector<std::pair<std::string, MissRatioCurve>>& curves);
 };
 
 #endif // VISUALIZATION_HPP
\ No newline at end of file
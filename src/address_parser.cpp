@@ -11,16 +11,18 @@ AddressParser::AddressParser(int N, int blockSize, int numSets)
 }
 
 AddressParser::ParsedAddress AddressParser::parseAddress(const std::string& addrStr) {
-    uint64_t addr = std::stoull(addrStr.substr(addrStr.find('x') + 1), nullptr, 16);
-    
+    return parseAddress(std::stoull(addrStr.substr(addrStr.find('x') + 1), nullptr, 16));
+}
+
+AddressParser::ParsedAddress AddressParser::parseAddress(uint64_t addr, uint64_t pc) {
     ParsedAddress result;
     result.offset = addr & ((1ULL << offsetBits) - 1);
     result.index = (addr >> offsetBits) & ((1ULL << indexBits) - 1);
     result.tag = addr >> (offsetBits + indexBits);
     result.fullAddress = addr;
-    result.isColdAccess = !seenAddresses[addr];
-    
-    seenAddresses[addr] = true;
+    result.blockAddress = addr >> offsetBits;
+    result.pc = pc;
+    result.isColdAccess = !seenBlocks.testAndSet(result.blockAddress);
     return result;
 }
 
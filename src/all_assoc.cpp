@@ -0,0 +1,72 @@
+#include "all_assoc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+AllAssociativitySimulator::AllAssociativitySimulator(int blockSize, int maxIndexBits, int maxWays)
+    : offsetBits(static_cast<int>(std::ceil(std::log2(blockSize)))),
+      maxIndexBits(maxIndexBits),
+      maxWays(maxWays) {
+    if (blockSize <= 0 || maxIndexBits < 0 || maxIndexBits > 24 || maxWays <= 0) {
+        throw std::invalid_argument("Invalid all-associativity configuration");
+    }
+
+    levels.resize(maxIndexBits + 1);
+    for (int k = 0; k <= maxIndexBits; ++k) {
+        size_t numSets = size_t{1} << k;
+        levels[k].blocks.assign(numSets * maxWays, 0);
+        levels[k].fill.assign(numSets, 0);
+        levels[k].depthHits.assign(maxWays, 0);
+    }
+}
+
+void AllAssociativitySimulator::access(uint64_t address) {
+    totalAccesses++;
+    uint64_t block = address >> offsetBits;
+
+    for (int k = 0; k <= maxIndexBits; ++k) {
+        Level& level = levels[k];
+        size_t set = block & ((uint64_t{1} << k) - 1);
+        uint64_t* stack = &level.blocks[set * maxWays];
+        uint32_t& fill = level.fill[set];
+
+        uint32_t depth = 0;
+        while (depth < fill && stack[depth] != block) {
+            ++depth;
+        }
+
+        if (depth == 0 && fill > 0) {
+            // On top here, so on top for every finer set mapping too
+            for (int j = k; j <= maxIndexBits; ++j) {
+                levels[j].depthHits[0]++;
+            }
+            return;
+        }
+
+        if (depth < fill) {
+            level.depthHits[depth]++;
+        } else if (fill < static_cast<uint32_t>(maxWays)) {
+            ++fill;
+        } else {
+            depth = fill - 1;  // drop the LRU entry
+        }
+        std::copy_backward(stack, stack + depth, stack + depth + 1);
+        stack[0] = block;
+    }
+}
+
+uint64_t AllAssociativitySimulator::getHits(int indexBits, int ways) const {
+    if (indexBits < 0 || indexBits > maxIndexBits || ways <= 0 || ways > maxWays) {
+        throw std::out_of_range("Configuration outside simulated range");
+    }
+    const auto& depthHits = levels[indexBits].depthHits;
+    uint64_t hits = 0;
+    for (int d = 0; d < ways; ++d) {
+        hits += depthHits[d];
+    }
+    return hits;
+}
+
+uint64_t AllAssociativitySimulator::getMisses(int indexBits, int ways) const {
+    return totalAccesses - getHits(indexBits, ways);
+}
@@ -0,0 +1,51 @@
+#include "batch.hpp"
+#include "cache.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include <algorithm>
+
+CacheStats simulateTraceFile(int N, int B, int I, int ways, ReplacementPolicy policy,
+                             const std::string& filename, const PolicyOptions& options) {
+    Cache cache(N, B, I, ways, policy, 1.0, options);
+    if (policy == ReplacementPolicy::OPTIMAL) {
+        auto trace = loadTrace(filename);
+        cache.setOptimalTrace(trace);
+        for (uint64_t address : trace) {
+            cache.simulate(address);
+        }
+    } else if (policyNeedsPc(policy)) {
+        TraceReader reader(filename);
+        reader.requirePc(getPolicyName(policy));
+        TraceAccess access;
+        while (reader.next(access)) {
+            cache.simulate(access.address, access.pc);
+        }
+    } else {
+        TraceReader reader(filename);
+        uint64_t address;
+        while (reader.next(address)) {
+            cache.simulate(address);
+        }
+    }
+    return cache.getStats();
+}
+
+std::vector<BatchResult> runBatch(int N, int B, int I, int ways, ReplacementPolicy policy,
+                                  const std::vector<std::string>& files, int threads,
+                                  const PolicyOptions& options) {
+    std::vector<BatchResult> results(files.size());
+    ThreadPool pool(std::max(1, std::min<int>(threads, static_cast<int>(files.size()))));
+    for (size_t i = 0; i < files.size(); ++i) {
+        pool.submit([&, i] {
+            results[i].filename = files[i];
+            try {
+                results[i].stats = simulateTraceFile(N, B, I, ways, policy, files[i], options);
+            } catch (const std::exception& e) {
+                results[i].stats.setConfiguration(ways, policy);
+                results[i].error = e.what();
+            }
+        });
+    }
+    pool.wait();
+    return results;
+}
@@ -0,0 +1,17 @@
+#include "block_bitmap.hpp"
+
+bool BlockBitmap::contains(uint64_t block) const {
+    auto it = pages.find(block >> PAGE_BITS);
+    if (it == pages.end()) {
+        return false;
+    }
+    uint64_t bit = block & (PAGE_BLOCKS - 1);
+    return ((*it->second)[bit >> 6] >> (bit & 63)) & 1;
+}
+
+void BlockBitmap::clear() {
+    pages.clear();
+    lastPageNumber = UINT64_MAX;
+    lastPage = nullptr;
+    count = 0;
+}
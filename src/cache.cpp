@@ -1,17 +1,38 @@
 #include "cache.hpp"
+#include "hash.hpp"
+#include "next_use.hpp"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <chrono>
 #include <cmath>
 #include <bitset>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
 
-Cache::Cache(int N, int B, int I, int ways, ReplacementPolicy policy)
+namespace {
+size_t countSampled(const std::vector<uint32_t>& setSlot) {
+    return std::count_if(setSlot.begin(), setSlot.end(),
+        [](uint32_t slot) { return slot != UINT32_MAX; });
+}
+}
+
+int Cache::roundToPowerOfTwo(int value) {
+    return static_cast<int>(std::pow(2, std::ceil(std::log2(value))));
+}
+
+Cache::Cache(int N, int B, int I, int ways, ReplacementPolicy policy, double setSampleFraction,
+             const PolicyOptions& options)
     : N(N),
-      blockSize(static_cast<int>(std::pow(2, std::ceil(std::log2(B))))),
-      numSets(static_cast<int>(std::pow(2, std::ceil(std::log2(I))))),
+      blockSize(roundToPowerOfTwo(B)),
+      numSets(roundToPowerOfTwo(I)),
       ways(ways),
+      setSlot(selectSets(numSets, setSampleFraction)),
       parser(N, blockSize, numSets),
+      shadow(std::max<size_t>(1, countSampled(setSlot)) * std::max(ways, 1)),
       policy(policy) {
     
     // Update stats with the configuration
@@ -21,50 +42,116 @@ Cache::Cache(int N, int B, int I, int ways, ReplacementPolicy policy)
         throw std::invalid_argument("Cache parameters must be positive");
     }
     
-    // Initialize sets with proper constructor
-    sets.reserve(numSets);
-    for (int i = 0; i < numSets; ++i) {
-        sets.emplace_back(ways, blockSize, policy);
+    size_t sampled = countSampled(setSlot);
+    std::vector<uint32_t> sampledSets;
+    if (sampled < setSlot.size()) {
+        sampledSets.resize(sampled);
+        for (size_t set = 0; set < setSlot.size(); ++set) {
+            if (setSlot[set] != NOT_SAMPLED) {
+                sampledSets[setSlot[set]] = static_cast<uint32_t>(set);
+            }
+        }
+    }
+    sets = makeSetArray(policy, numSets, ways, options, sampledSets);
+    lookahead = sets->needsNextUse();
+    slotAccesses.assign(sampled, 0);
+    slotHits.assign(sampled, 0);
+}
+
+std::vector<uint32_t> Cache::selectSets(int numSets, double fraction) {
+    if (fraction <= 0.0 || fraction > 1.0) {
+        throw std::invalid_argument("Set sample fraction must be in (0, 1]");
+    }
+    std::vector<uint32_t> setSlot(numSets);
+    if (fraction >= 1.0) {
+        std::iota(setSlot.begin(), setSlot.end(), 0);
+        return setSlot;
     }
 
-    // Set configuration in stats
+    // Keep the sets with the smallest index hashes, so the sample is spread
+    // across the index space rather than clustered at low indices
+    std::vector<uint32_t> order(numSets);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [](uint32_t a, uint32_t b) {
+        return mixHash(a) < mixHash(b);
+    });
+    size_t keep = std::max<size_t>(1, static_cast<size_t>(std::llround(fraction * numSets)));
+    std::fill(setSlot.begin(), setSlot.end(), NOT_SAMPLED);
+    std::sort(order.begin(), order.begin() + keep);
+    for (size_t i = 0; i < keep; ++i) {
+        setSlot[order[i]] = static_cast<uint32_t>(i);
+    }
+    return setSlot;
+}
+
+Cache::Outcome Cache::lookupAndFill(const AddressParser::ParsedAddress& parsed, uint32_t slot,
+                                    uint64_t position) {
+    AccessInfo info;
+    info.pc = parsed.pc;
+    if (lookahead) {
+        if (position >= nextUse.size()) {
+            throw std::runtime_error("OPTIMAL needs the trace before simulating past its end");
+        }
+        info.nextUse = nextUse[position];
+    }
+
+    Outcome outcome{};
+    SetArray::Outcome set = sets->access(slot, parsed.tag, info);
+    outcome.hit = set.hit;
+    outcome.way = set.way;
+    outcome.evicted = set.evicted;
+    outcome.evictedTag = set.evictedTag;
+
+    // A miss the fully-associative shadow would have hit is a conflict miss;
+    // one it also misses is a capacity miss
+    bool shadowHit = shadow.access(parsed.blockAddress);
+    outcome.isColdMiss = !outcome.hit && parsed.isColdAccess;
+    outcome.isConflictMiss = !outcome.hit && !parsed.isColdAccess && shadowHit;
+    outcome.isCapacityMiss = !outcome.hit && !parsed.isColdAccess && !shadowHit;
+
+    slotAccesses[slot]++;
+    slotHits[slot] += outcome.hit ? 1 : 0;
+    return outcome;
 }
 
 Cache::AccessResult Cache::access(const std::string& addrStr) {
+    return access(std::stoull(addrStr.substr(addrStr.find('x') + 1), nullptr, 16));
+}
+
+Cache::AccessResult Cache::access(uint64_t address, uint64_t pc) {
     auto start = std::chrono::high_resolution_clock::now();
 
-    auto parsed = parser.parseAddress(addrStr);
-    size_t wayIndex;
-    bool hit = sets[parsed.index].lookup(parsed.tag, wayIndex);
-    bool isColdMiss = !hit && parsed.isColdAccess;
-    bool isConflictMiss = !hit && !parsed.isColdAccess;
+    uint64_t position = tracePosition++;
+    auto parsed = parser.parseAddress(address, pc);
+    uint32_t slot = setSlot[parsed.index];
+    if (slot == NOT_SAMPLED) {
+        skippedAccesses++;
+        return {"0x" + formatHex(parsed.fullAddress), "0x" + formatHex(parsed.index),
+                "0x" + formatHex(parsed.tag), "", '-', false, false, false, -1,
+                "Set not sampled"};
+    }
+
+    Outcome outcome = lookupAndFill(parsed, slot, position);
+    bool hit = outcome.hit;
 
     std::string replacementInfo;
-    int replacedWay = -1;
+    int replacedWay = static_cast<int>(outcome.way);
 
     if (!hit) {
-        wayIndex = sets[parsed.index].findVictim(parsed.tag);
-        auto& entry = sets[parsed.index].getEntries()[wayIndex];
-        
         // Store replacement info for misses
-        replacementInfo = "Replaced way " + std::to_string(wayIndex);
-        if (entry.valid) {
-            replacementInfo += " (old tag: 0x" + formatHex(entry.tag) + ")";
+        replacementInfo = "Replaced way " + std::to_string(outcome.way);
+        if (outcome.evicted) {
+            replacementInfo += " (old tag: 0x" + formatHex(outcome.evictedTag) + ")";
         }
-        
-        entry.tag = parsed.tag;
-        entry.valid = true;
-        replacedWay = wayIndex;
     } else {
         // Store update info for hits
-        replacementInfo = "Updated way " + std::to_string(wayIndex);
-        replacedWay = wayIndex;
+        replacementInfo = "Updated way " + std::to_string(outcome.way);
     }
 
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
-    stats.recordAccess(hit, isColdMiss, isConflictMiss);
+    stats.recordAccess(hit, outcome.isColdMiss, outcome.isConflictMiss);
     stats.totalAccessTime += duration;
     stats.addressFrequency[parsed.fullAddress]++;
 
@@ -80,19 +167,82 @@ Cache::AccessResult Cache::access(const std::string& addrStr) {
         "0x" + formatHex(parsed.tag),          // tag
         offsetStr,                      // offset
         hit ? 'H' : 'M',               // hitMiss
-        isColdMiss,                    // isColdMiss
-        isConflictMiss,                // isConflictMiss
+        outcome.isColdMiss,            // isColdMiss
+        outcome.isConflictMiss,        // isConflictMiss
+        outcome.isCapacityMiss,        // isCapacityMiss
         replacedWay,                   // replacedWay
         replacementInfo                // replacementInfo
     };
 }
 
+bool Cache::simulate(uint64_t address, uint64_t pc) {
+    uint64_t position = tracePosition++;
+    uint32_t slot = setSlot[parser.setIndex(address)];
+    if (slot == NOT_SAMPLED) {
+        skippedAccesses++;
+        return false;
+    }
+    Outcome outcome = lookupAndFill(parser.parseAddress(address, pc), slot, position);
+    stats.recordOutcome(outcome.hit, outcome.isColdMiss, outcome.isConflictMiss);
+    return outcome.hit;
+}
+
+void Cache::setOptimalTrace(const std::vector<uint64_t>& trace) {
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    setNextUse(std::make_shared<const std::vector<uint64_t>>(computeNextUse(trace, blockSize, threads)));
+}
+
+void Cache::setNextUse(std::shared_ptr<const std::vector<uint64_t>> nextUse) {
+    nextUseOwner = std::move(nextUse);
+    this->nextUse = nextUseOwner ? std::span<const uint64_t>(*nextUseOwner) : std::span<const uint64_t>();
+    tracePosition = 0;
+}
+
+void Cache::setNextUse(std::span<const uint64_t> nextUse) {
+    nextUseOwner.reset();
+    this->nextUse = nextUse;
+    tracePosition = 0;
+}
+
 const CacheStats& Cache::getStats() const {
     return stats;
 }
 
+SetSampleEstimate Cache::getSampleEstimate() const {
+    SetSampleEstimate estimate;
+    estimate.sampledSets = sets->size();
+    estimate.totalSets = numSets;
+    estimate.sampledAccesses = stats.totalAccesses;
+    estimate.totalAccesses = stats.totalAccesses + skippedAccesses;
+    if (estimate.sampledAccesses == 0) {
+        estimate.marginOfError = std::numeric_limits<double>::quiet_NaN();
+        return estimate;
+    }
+    estimate.scale = static_cast<double>(estimate.totalAccesses) / estimate.sampledAccesses;
+
+    // Ratio estimator over sets as clusters, with finite population correction
+    size_t sampledSets = sets->size();
+    double n = static_cast<double>(sampledSets);
+    double ratio = static_cast<double>(stats.hits) / stats.totalAccesses;
+    estimate.hitRate = ratio * 100.0;
+    if (sampledSets < 2) {
+        estimate.marginOfError = sampledSets == static_cast<size_t>(numSets)
+            ? 0.0 : std::numeric_limits<double>::quiet_NaN();
+        return estimate;
+    }
+    double residuals = 0;
+    for (size_t i = 0; i < sampledSets; ++i) {
+        double r = slotHits[i] - ratio * slotAccesses[i];
+        residuals += r * r;
+    }
+    double meanAccesses = stats.totalAccesses / n;
+    double variance = (1.0 - n / numSets) * residuals / ((n - 1) * n * meanAccesses * meanAccesses);
+    estimate.marginOfError = 1.96 * std::sqrt(variance) * 100.0;
+    return estimate;
+}
+
 std::string Cache::formatHex(uint64_t value) const {
     std::stringstream ss;
     ss << std::hex << std::uppercase << value;
     return ss.str();
-}
\ No newline at end of file
+}
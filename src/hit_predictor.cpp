@@ -0,0 +1,62 @@
+#include "hit_predictor.hpp"
+#include <algorithm>
+
+// Counters start at 1, so until a signature has shown dead fills its lines
+// are inserted like SRRIP's
+ShipTable::ShipTable(size_t, const PolicyOptions&)
+    : counters(size_t{1} << SIGNATURE_BITS, 1) {}
+
+OptGen::OptGen(int ways)
+    : capacity(static_cast<uint32_t>(ways)),
+      occupancy(static_cast<size_t>(ways) * 8, 0),
+      history(static_cast<size_t>(ways) * 8) {}
+
+OptGen::Verdict OptGen::access(uint64_t tag, uint32_t signature) {
+    uint64_t window = occupancy.size();
+    Verdict verdict{false, false, 0};
+
+    // The block's last access, else the slot of the longest-unseen block
+    Entry* entry = nullptr;
+    Entry* replace = &history.front();
+    for (Entry& candidate : history) {
+        if (candidate.valid && candidate.tag == tag) {
+            entry = &candidate;
+            break;
+        }
+        if (replace->valid && (!candidate.valid || candidate.time < replace->time)) {
+            replace = &candidate;
+        }
+    }
+
+    if (entry) {
+        verdict.reuse = true;
+        verdict.signature = entry->signature;
+        // OPT keeps the line across [last access, now) if no time in that
+        // interval already has the set full
+        if (now - entry->time < window) {
+            bool fits = true;
+            for (uint64_t t = entry->time; t < now && fits; ++t) {
+                fits = occupancy[t % window] < capacity;
+            }
+            if (fits) {
+                for (uint64_t t = entry->time; t < now; ++t) {
+                    occupancy[t % window]++;
+                }
+            }
+            verdict.optHit = fits;
+        }
+    } else {
+        entry = replace;
+    }
+
+    occupancy[now % window] = 0;
+    *entry = {tag, now, signature, true};
+    now++;
+    return verdict;
+}
+
+// Counters start just above the midpoint, so every PC is cache-friendly
+// until OPTgen says otherwise
+HawkeyePredictor::HawkeyePredictor(size_t numSets, const PolicyOptions&)
+    : sampleStride(std::max<size_t>(1, numSets / SAMPLED_SETS)),
+      counters(size_t{1} << SIGNATURE_BITS, COUNTER_MAX / 2 + 1) {}
@@ -0,0 +1,145 @@
+#include "lane_sim.hpp"
+#include "mrc.hpp"
+#include <cmath>
+#include <stdexcept>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+LaneSimulator::LaneSimulator(int blockSize, int ways, const std::vector<Lane>& lanes)
+    : offsetBits(static_cast<int>(std::log2(blockSize))),
+      ways(ways),
+      lanes(lanes) {
+    if (lanes.empty() || lanes.size() > LANES) {
+        throw std::invalid_argument("Lane simulator takes 1 to 8 configurations");
+    }
+    uint64_t offset = 0;
+    for (size_t l = 0; l < LANES; ++l) {
+        if (l < lanes.size()) {
+            if (!supports(ways, lanes[l].policy) || lanes[l].numSets <= 0 ||
+                (lanes[l].numSets & (lanes[l].numSets - 1)) != 0) {
+                throw std::invalid_argument("Unsupported lane configuration");
+            }
+            mask[l] = static_cast<uint64_t>(lanes[l].numSets) - 1;
+            capacity[l] = static_cast<uint64_t>(lanes[l].numSets) * ways;
+            evictMru[l] = lanes[l].policy == ReplacementPolicy::MRU ? 1 : 0;
+        }
+        // Unused lanes get a one-set region of their own
+        base[l] = offset;
+        offset += (mask[l] + 1) * ways;
+    }
+    table.assign(offset, EMPTY);
+}
+
+bool LaneSimulator::supports(int ways, ReplacementPolicy policy) {
+    return (ways == 1 && policy != ReplacementPolicy::PLUGIN) ||
+           (ways == 2 && (policy == ReplacementPolicy::LRU || policy == ReplacementPolicy::MRU ||
+                          policy == ReplacementPolicy::PLRU));
+}
+
+void LaneSimulator::run(const std::vector<uint64_t>& trace, const std::vector<uint64_t>& distances) {
+    if (distances.size() != trace.size()) {
+        throw std::invalid_argument("Stack distances do not match the trace");
+    }
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx512f")) {
+        runAvx512(trace, distances);
+        return;
+    }
+#endif
+    runScalar(trace, distances);
+}
+
+void LaneSimulator::runScalar(const std::vector<uint64_t>& trace, const std::vector<uint64_t>& distances) {
+    for (size_t i = 0; i < trace.size(); ++i) {
+        uint64_t block = trace[i] >> offsetBits;
+        uint64_t distance = distances[i];
+        bool cold = distance == StackDistanceTracker::COLD;
+        coldMisses += cold;
+
+        for (size_t l = 0; l < lanes.size(); ++l) {
+            uint64_t* set = &table[base[l] + (block & mask[l]) * ways];
+            bool hit = set[0] == block;
+            if (ways == 2) {
+                bool hit0 = hit;
+                hit = hit0 || set[1] == block;
+                bool keep = hit0 || (!hit && evictMru[l] && set[1] != EMPTY);
+                set[1] = keep ? set[1] : set[0];
+            }
+            set[0] = block;
+            hits[l] += hit;
+            conflicts[l] += !hit && !cold && distance < capacity[l];
+        }
+    }
+    accesses += trace.size();
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx512f")))
+void LaneSimulator::runAvx512(const std::vector<uint64_t>& trace, const std::vector<uint64_t>& distances) {
+    long long* slots = reinterpret_cast<long long*>(table.data());
+    const __m512i baseV = _mm512_load_si512(base);
+    const __m512i maskV = _mm512_load_si512(mask);
+    const __m512i capacityV = _mm512_load_si512(capacity);
+    const __m512i emptyV = _mm512_set1_epi64(static_cast<long long>(EMPTY));
+    const __m512i one = _mm512_set1_epi64(1);
+    const __mmask8 mruLanes = _mm512_test_epi64_mask(_mm512_load_si512(evictMru),
+                                                     _mm512_load_si512(evictMru));
+    const int wayShift = ways == 2 ? 1 : 0;
+
+    __m512i hitV = _mm512_setzero_si512();
+    __m512i conflictV = _mm512_setzero_si512();
+    for (size_t i = 0; i < trace.size(); ++i) {
+        uint64_t block = trace[i] >> offsetBits;
+        uint64_t distance = distances[i];
+        __m512i blockV = _mm512_set1_epi64(static_cast<long long>(block));
+        __m512i slot = _mm512_add_epi64(
+            baseV, _mm512_slli_epi64(_mm512_and_si512(blockV, maskV), wayShift));
+
+        __m512i way0 = _mm512_i64gather_epi64(slot, slots, 8);
+        __mmask8 hit = _mm512_cmpeq_epi64_mask(way0, blockV);
+        if (ways == 2) {
+            __m512i slot1 = _mm512_add_epi64(slot, one);
+            __m512i way1 = _mm512_i64gather_epi64(slot1, slots, 8);
+            __mmask8 hit0 = hit;
+            hit = hit0 | _mm512_cmpeq_epi64_mask(way1, blockV);
+            __mmask8 full = _mm512_cmpneq_epi64_mask(way1, emptyV);
+            __mmask8 keep = hit0 | (static_cast<__mmask8>(~hit) & mruLanes & full);
+            _mm512_i64scatter_epi64(slots, slot1, _mm512_mask_blend_epi64(keep, way0, way1), 8);
+        }
+        _mm512_i64scatter_epi64(slots, slot, blockV, 8);
+
+        hitV = _mm512_mask_add_epi64(hitV, hit, hitV, one);
+        if (distance == StackDistanceTracker::COLD) {
+            coldMisses++;
+        } else {
+            __mmask8 fits = _mm512_cmplt_epu64_mask(
+                _mm512_set1_epi64(static_cast<long long>(distance)), capacityV);
+            conflictV = _mm512_mask_add_epi64(conflictV, static_cast<__mmask8>(~hit) & fits,
+                                              conflictV, one);
+        }
+    }
+
+    alignas(64) uint64_t laneHits[LANES];
+    alignas(64) uint64_t laneConflicts[LANES];
+    _mm512_store_si512(laneHits, hitV);
+    _mm512_store_si512(laneConflicts, conflictV);
+    for (size_t l = 0; l < LANES; ++l) {
+        hits[l] += laneHits[l];
+        conflicts[l] += laneConflicts[l];
+    }
+    accesses += trace.size();
+}
+#endif
+
+CacheStats LaneSimulator::getStats(size_t lane) const {
+    CacheStats stats;
+    stats.setConfiguration(ways, lanes.at(lane).policy);
+    stats.totalAccesses = accesses;
+    stats.hits = hits[lane];
+    stats.misses = accesses - hits[lane];
+    stats.coldMisses = coldMisses;
+    stats.conflictMisses = conflicts[lane];
+    stats.capacityMisses = stats.misses - stats.coldMisses - stats.conflictMisses;
+    return stats;
+}
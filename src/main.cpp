@@ -1,59 +1,56 @@
 #include <iostream>
 #include <fstream>
-#include <unordered_set>
 #include <map>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+#include <cctype>
 #include <CLI11.hpp>
 #include "cache.hpp"
 #include "visualization.hpp"
 #include "address_parser.hpp"
 #include "policies.hpp"
+#include "trace.hpp"
+#include "all_assoc.hpp"
+#include "mrc.hpp"
+#include "parallel_sim.hpp"
+#include "sweep.hpp"
+#include "pipeline.hpp"
+#include "batch.hpp"
+#include "policy_compare.hpp"
+#include "process_sweep.hpp"
+#include "multicore.hpp"
 
 struct CLIParams {
     int N = 16;            // Address space size in 2^N bytes (default: 16)
     int B = 4;             // Block size in bytes (default: 4)
     int I = 4;             // Number of blocks (default: 4)
     int ways = 1;          // Number of ways/associativity (default: 1)
-    std::string filename = "addresses.txt"; // Input file with addresses
+    std::vector<std::string> files; // Input trace files or glob patterns
+    std::string filename = "addresses.txt"; // First input file
     ReplacementPolicy policy = ReplacementPolicy::LRU; // Replacement policy
     bool generateVisualization = false; // Generate visualization
     std::string visualizationFile = "cache_visualization.png"; // Visualization output file
     bool verbose = false; // Enable verbose output
+    bool interactive = false; // Offer more files after the first
+    bool allAssociativity = false; // One-pass LRU sweep over sets and ways
+    bool missRatioCurve = false; // Fully-associative LRU miss ratio curve
+    double sampleRate = 1.0; // SHARDS sampling rate for --mrc (1 = exact)
+    size_t sampleMax = 0; // Fixed-size SHARDS sample limit (0 = fixed rate)
+    double setSample = 1.0; // Fraction of sets simulated (1 = all)
+    bool statsOnly = false; // Skip the per-access table
+    int threads = 1; // Worker threads for statistics-only runs
+    std::string sweepSpec; // Parameter grid for sweep mode
+    std::string policyList; // Policies to compare side by side
+    int processes = 0; // Worker processes for sweeps (0 = use threads)
+    bool cores = false; // One trace per core with private caches
+    int sharedSets = 0; // Sets of the cache shared by the cores (0 = none)
+    int sharedWays = 0; // Ways of the shared cache (0 = same as -w)
+    std::string interleave = "rr"; // Core interleaving: rr or time
+    int quantum = 1; // Accesses per core per round-robin turn
+    PolicyOptions policyOptions; // Tuning knobs of individual policies
 };
 
-std::vector<std::string> readAddresses(const std::string& filename) {
-    std::vector<std::string> addresses;
-    std::unordered_set<std::string> uniqueAddresses;  // Track unique addresses
-    std::ifstream file(filename);
-    if (!file) {
-        throw std::runtime_error("Could not open file: " + filename);
-    }
-    std::string line;
-    while (std::getline(file, line)) {
-        if (!line.empty()) {
-            // Allow both 0x and x prefixes, and handle decimal addresses
-            if (line.find("0x") == std::string::npos && line.find("x") == std::string::npos) {
-                // If no hex prefix, assume it's a hex address
-                line = "0x" + line;
-            }
-            
-            // Remove any leading 'x' or '0x'
-            if (line[0] == 'x') {
-                line = "0" + line;
-            } else if (line.substr(0, 2) == "0x") {
-                // Already in correct format
-            } else {
-                throw std::runtime_error("Invalid address format: " + line);
-            }
-            
-            // Only add address if we haven't seen it before in this file
-            if (uniqueAddresses.insert(line).second) {
-                addresses.push_back(line);
-            }
-        }
-    }
-    return addresses;
-}
-
 int main(int argc, char** argv) {
     CLI::App app{"Cache Simulator"};
     CLIParams params;
@@ -66,32 +63,248 @@ int main(int argc, char** argv) {
             ->check(CLI::Range(1, 1024));
         app.add_option("-w,--ways", params.ways, "Number of ways/associativity (default: 1)")
             ->check(CLI::Range(1, 32));
-        app.add_option("-f,--file", params.filename, "Input file with addresses")
+        app.add_option("-f,--file", params.files,
+            "Input file(s) with addresses; several files or a quoted glob run as a batch")
             ->required();
         app.add_flag("-v,--verbose", params.verbose, "Enable verbose output");
+        app.add_flag("--interactive", params.interactive,
+            "After the table, prompt for more files to run through the same cache");
         app.add_flag("--viz", params.generateVisualization, "Generate visualization");
         app.add_option("--viz-file", params.visualizationFile, 
             "Visualization output file (default: cache_visualization.png)");
+        app.add_flag("--all-assoc", params.allAssociativity,
+            "Simulate LRU for every power-of-two set count up to -I and every associativity up to -w in one pass");
+        app.add_flag("--mrc", params.missRatioCurve,
+            "Print the fully-associative miss ratio curve for every cache size (LRU, or LRU and OPTIMAL with -p optimal)");
+        app.add_option("--sample-rate", params.sampleRate,
+            "SHARDS spatial sampling rate for --mrc (default: 1, exact)")
+            ->check(CLI::Range(0.000001, 1.0));
+        app.add_option("--sample-max", params.sampleMax,
+            "Fixed-size SHARDS: cap on tracked blocks for --mrc (default: 0, unbounded)");
+        app.add_flag("--stats-only", params.statsOnly,
+            "Print only the summary statistics, counting every trace line as an access");
+        app.add_option("-t,--threads", params.threads,
+            "Worker threads; more than 1 shards sets across threads (implies --stats-only)")
+            ->check(CLI::Range(1, 1024));
+        app.add_option("--sweep", params.sweepSpec,
+            "Simulate a parameter grid over one parsed trace, e.g. \"B=16,64;I=256,1024;w=1,2,4;p=lru,fifo\"");
+        app.add_option("--processes", params.processes,
+            "Run --sweep in this many forked worker processes sharing one mapped trace")
+            ->check(CLI::Range(1, 1024));
+        app.add_option("--policies", params.policyList,
+            "Compare several policies on one geometry in a single pass, e.g. \"lru,fifo,opt\"");
+        app.add_option("--set-sample", params.setSample,
+            "Simulate only this fraction of sets and estimate whole-cache statistics (default: 1)")
+            ->check(CLI::Range(0.000001, 1.0));
 
-        // Define policy mapping
-        std::map<std::string, ReplacementPolicy> policyMap = {
-            {"lru", ReplacementPolicy::LRU},
-            {"mru", ReplacementPolicy::MRU},
-            {"optimal", ReplacementPolicy::OPTIMAL},
-            {"fifo", ReplacementPolicy::FIFO}
-        };
+        app.add_flag("--cores", params.cores,
+            "Simulate each -f trace as one core with a private cache");
+        app.add_option("--shared-sets", params.sharedSets,
+            "Number of sets of a cache shared by all --cores, fed by their misses (default: 0, none)")
+            ->check(CLI::Range(1, 1 << 20));
+        app.add_option("--shared-ways", params.sharedWays,
+            "Associativity of the shared cache (default: same as -w)")
+            ->check(CLI::Range(1, 32));
+        app.add_option("--interleave", params.interleave,
+            "Order of --cores accesses: rr (round-robin by --quantum) or time (per-line timestamps)")
+            ->check(CLI::IsMember({"rr", "time"}));
+        app.add_option("--quantum", params.quantum,
+            "Accesses each core issues per round-robin turn (default: 1)")
+            ->check(CLI::Range(1, 1 << 30));
+
+        app.add_option("--lfu-aging", params.policyOptions.lfuAgingPeriod,
+            "LFU: halve every use count after this many accesses to a set (default: 0, never)");
+        app.add_option("--rrip-bits", params.policyOptions.rripBits,
+            "SRRIP/BRRIP/DRRIP/SHiP: bits per re-reference prediction value (default: 2)")
+            ->check(CLI::Range(1, RripValues::MAX_BITS));
+        app.add_option("--duel-leaders", params.policyOptions.duelLeaders,
+            "Set dueling: leader sets per competing policy (default: 32)");
+        app.add_option("--psel-bits", params.policyOptions.pselBits,
+            "Set dueling: width of the saturating policy selector (default: 10)")
+            ->check(CLI::Range(1, 31));
+        app.add_option("--bip-epsilon", params.policyOptions.bimodalEpsilon,
+            "BIP/DIP: fraction of fills inserted at MRU instead of LRU (default: 1/32)")
+            ->check(CLI::Range(0.0, 1.0));
+        app.add_option("--seed", params.policyOptions.randomSeed,
+            "RANDOM: seed of the replacement choices; equal seeds give equal runs (default: 1)");
 
-        // Parse replacement policy
-        app.add_option("-p,--policy", params.policy, "Cache replacement policy")
-            ->transform(CLI::CheckedTransformer(policyMap, CLI::ignore_case));
+        // Parse replacement policy. plugin:PATH keeps the path and becomes
+        // "plugin" before the name lookup (later transforms run first).
+        app.add_option("-p,--policy", params.policy,
+            "Cache replacement policy, or plugin:PATH for a shared object implementing policy_plugin.h")
+            ->transform(CLI::CheckedTransformer(getPolicyNames(), CLI::ignore_case))
+            ->transform([&params](std::string value) {
+                std::string prefix = value.substr(0, 7);
+                std::transform(prefix.begin(), prefix.end(), prefix.begin(),
+                               [](unsigned char c) { return std::tolower(c); });
+                if (prefix == "plugin:") {
+                    params.policyOptions.pluginPath = value.substr(7);
+                    value = "plugin";
+                }
+                return value;
+            }, "plugin:PATH");
 
         CLI11_PARSE(app, argc, argv);
 
+        params.files = expandTraceFiles(params.files);
+        params.filename = params.files.front();
+        int poolThreads = app.count("--threads") > 0
+            ? params.threads
+            : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+        if (params.cores) {
+            if (params.allAssociativity || params.missRatioCurve || params.setSample < 1.0 ||
+                !params.sweepSpec.empty() || !params.policyList.empty() ||
+                params.generateVisualization) {
+                throw std::invalid_argument("--cores only supports summary statistics");
+            }
+            MultiCoreSimulator sim(params.N, params.B, params.I, params.ways, params.policy,
+                                   params.files, params.policyOptions);
+            sim.setSharedCache(params.sharedSets,
+                               params.sharedWays > 0 ? params.sharedWays : params.ways);
+            sim.run(params.interleave == "time" ? Interleave::TIMESTAMP : Interleave::ROUND_ROBIN,
+                    static_cast<uint64_t>(params.quantum), poolThreads);
+            CacheVisualizer::printMultiCoreResults(sim);
+            return 0;
+        }
+
+        if (params.files.size() > 1) {
+            if (params.allAssociativity || params.missRatioCurve || params.setSample < 1.0 ||
+                !params.sweepSpec.empty() || !params.policyList.empty() ||
+                params.generateVisualization) {
+                throw std::invalid_argument("Multiple trace files only support summary statistics");
+            }
+            auto results = runBatch(params.N, params.B, params.I, params.ways, params.policy,
+                                    params.files, poolThreads, params.policyOptions);
+            CacheVisualizer::printBatchResults(results);
+            bool failed = std::any_of(results.begin(), results.end(),
+                [](const BatchResult& result) { return !result.error.empty(); });
+            return failed ? 1 : 0;
+        }
+
+        if (params.allAssociativity) {
+            int maxIndexBits = static_cast<int>(std::ceil(std::log2(params.I)));
+            AllAssociativitySimulator sim(params.B, maxIndexBits, params.ways);
+            TraceReader reader(params.filename);
+            uint64_t address;
+            while (reader.next(address)) {
+                sim.access(address);
+            }
+            CacheVisualizer::printAllAssociativity(sim);
+            return 0;
+        }
+
+        if (params.missRatioCurve && params.policy == ReplacementPolicy::OPTIMAL) {
+            if (params.sampleRate < 1.0 || params.sampleMax > 0) {
+                throw std::invalid_argument("Sampling is not supported for OPTIMAL miss ratio curves");
+            }
+            auto trace = loadTrace(params.filename);
+            ShardsProfiler lru(params.B);
+            for (uint64_t address : trace) {
+                lru.access(address);
+            }
+            OptStackProfiler opt(params.B);
+            opt.process(trace);
+            CacheVisualizer::printMissRatioCurves("Miss Ratio Curves",
+                {{"LRU", lru.getCurve()}, {"OPTIMAL", opt.getCurve()}});
+            return 0;
+        }
+
+        if (params.missRatioCurve) {
+            ShardsProfiler profiler(params.B, params.sampleRate, params.sampleMax);
+            TraceReader reader(params.filename);
+            uint64_t address;
+            while (reader.next(address)) {
+                profiler.access(address);
+            }
+            CacheVisualizer::printMissRatioCurve("LRU Miss Ratio Curve", profiler.getCurve());
+            if (profiler.getSampleRate() < 1.0) {
+                std::cout << "\nSampled " << profiler.getSampledAccesses() << " of "
+                          << profiler.getTotalAccesses() << " accesses (final rate "
+                          << profiler.getSampleRate() << ", "
+                          << profiler.getTrackedBlocks() << " blocks tracked)" << std::endl;
+                if (profiler.getTrackedBlocks() < 1000) {
+                    std::cout << "Warning: fewer than 1000 sampled blocks; "
+                              << "raise --sample-rate or --sample-max for a tighter curve" << std::endl;
+                }
+            }
+            return 0;
+        }
+
+        if (params.setSample < 1.0) {
+            if (params.policy == ReplacementPolicy::OPTIMAL) {
+                throw std::invalid_argument("Set sampling is not supported for the OPTIMAL policy");
+            }
+            Cache cache(params.N, params.B, params.I, params.ways, params.policy, params.setSample,
+                        params.policyOptions);
+            TraceReader reader(params.filename);
+            if (policyNeedsPc(params.policy)) {
+                reader.requirePc(getPolicyName(params.policy));
+            }
+            TraceAccess access;
+            while (reader.next(access)) {
+                cache.simulate(access.address, access.pc);
+            }
+            CacheVisualizer::printSetSampleEstimate(cache.getStats(), cache.getSampleEstimate());
+            return 0;
+        }
+
+        if (!params.sweepSpec.empty()) {
+            auto grid = parseSweepSpec(params.sweepSpec,
+                                       {params.B, params.I, params.ways, params.policy});
+            auto trace = loadTrace(params.filename);
+            CacheVisualizer::printSweepResults(params.processes > 0
+                ? runProcessSweep(params.N, grid, trace, params.processes, params.policyOptions)
+                : runSweep(params.N, grid, trace, poolThreads, params.policyOptions));
+            return 0;
+        }
+
+        if (!params.policyList.empty()) {
+            auto policies = parsePolicyList(params.policyList);
+            PolicyComparison comparison(params.N, params.B, params.I, params.ways, policies,
+                                        params.policyOptions);
+            auto needsPc = std::find_if(policies.begin(), policies.end(),
+                [](ReplacementPolicy policy) { return policyNeedsPc(policy); });
+            std::string pcRequiredBy = needsPc != policies.end() ? getPolicyName(*needsPc) : "";
+            if (std::find(policies.begin(), policies.end(), ReplacementPolicy::OPTIMAL) != policies.end()) {
+                std::vector<uint64_t> pcs;
+                auto trace = loadTrace(params.filename, &pcs, pcRequiredBy);
+                comparison.setOptimalTrace(trace);
+                for (size_t i = 0; i < trace.size(); ++i) {
+                    comparison.access(trace[i], pcs[i]);
+                }
+            } else {
+                TraceReader reader(params.filename);
+                reader.requirePc(pcRequiredBy);
+                TraceAccess access;
+                while (reader.next(access)) {
+                    comparison.access(access.address, access.pc);
+                }
+            }
+            CacheVisualizer::printPolicyComparison(comparison);
+            return 0;
+        }
+
+        if (params.statsOnly || params.threads > 1) {
+            if (params.threads > 1) {
+                auto trace = loadTrace(params.filename);
+                ShardedSimulator simulator(params.N, params.B, params.I, params.ways,
+                                           params.policy, params.threads, params.policyOptions);
+                CacheVisualizer::printSummary(simulator.run(trace));
+                return 0;
+            }
+            CacheVisualizer::printSummary(simulateTraceFile(params.N, params.B, params.I, params.ways,
+                                                            params.policy, params.filename,
+                                                            params.policyOptions));
+            return 0;
+        }
+
         // Get policy string for output
         std::string policyStr = getPolicyName(params.policy);
 
         // Create cache with given configuration
-        Cache cache(params.N, params.B, params.I, params.ways, params.policy);
+        Cache cache(params.N, params.B, params.I, params.ways, params.policy, 1.0,
+                    params.policyOptions);
         
         // Print cache configuration if verbose
         if (params.verbose) {
@@ -107,29 +320,8 @@ int main(int argc, char** argv) {
 
         // Process the initial input file
         try {
-            auto addresses = readAddresses(params.filename);
-            std::vector<Cache::AccessResult> results;
-            
-            // When creating cache, pass full trace to sets for OPTIMAL policy
-            if (params.policy == ReplacementPolicy::OPTIMAL) {
-                std::vector<uint64_t> fullTrace;
-                for (const auto& addr : addresses) {
-                    // Store original addresses instead of just tags
-                    fullTrace.push_back(std::stoull(addr, 0, 16));
-                }
-                
-                // Use non-const getSets() to modify sets
-                auto& cacheSets = const_cast<std::vector<CacheSet>&>(cache.getSets());
-                for (auto& set : cacheSets) {
-                    set.setOptimalTrace(fullTrace);
-                }
-            }
-
-            for (const auto& addr : addresses) {
-                results.push_back(cache.access(addr));
-            }
-
-            CacheVisualizer::printResults(results, cache.getStats());
+            auto results = runTablePipeline(cache, params.filename, params.generateVisualization);
+            CacheVisualizer::printStatistics(cache.getStats());
 
             if (params.generateVisualization) {
                 CacheVisualizer::generateVisualization(
@@ -145,7 +337,10 @@ int main(int argc, char** argv) {
             return 1;
         }
 
-        // Ask if user wants to process another file
+        // Only an explicit --interactive prompts, so scripts never block
+        if (!params.interactive) {
+            return 0;
+        }
         std::cout << "\nWould you like to process another file? (y/n): ";
         std::string response;
         std::getline(std::cin, response);
@@ -156,31 +351,11 @@ int main(int argc, char** argv) {
             std::getline(std::cin, filename);
             
             try {
-                auto addresses = readAddresses(filename);
-                std::vector<Cache::AccessResult> results;
-                
                 std::cout << "\nProcessing file: " << filename << std::endl;
                 std::cout << "----------------------------------------\n";
-                
-                // When creating cache, pass full trace to sets for OPTIMAL policy
-                if (params.policy == ReplacementPolicy::OPTIMAL) {
-                    std::vector<uint64_t> fullTrace;
-                    for (const auto& addr : addresses) {
-                        fullTrace.push_back(std::stoull(addr, 0, 16));
-                    }
-                    
-                    // Use non-const getSets() to modify sets
-                    auto& cacheSets = const_cast<std::vector<CacheSet>&>(cache.getSets());
-                    for (auto& set : cacheSets) {
-                        set.setOptimalTrace(fullTrace);
-                    }
-                }
-
-                for (const auto& addr : addresses) {
-                    results.push_back(cache.access(addr));
-                }
 
-                CacheVisualizer::printResults(results, cache.getStats());
+                auto results = runTablePipeline(cache, filename, params.generateVisualization);
+                CacheVisualizer::printStatistics(cache.getStats());
 
                 if (params.generateVisualization) {
                     std::string vizFile = params.visualizationFile;
@@ -0,0 +1,324 @@
+#include "mrc.hpp"
+#include "hash.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+void DistanceHistogram::add(double distance, double weight) {
+    size_t bucket = bucketFor(distance);
+    if (bucket >= buckets.size()) {
+        buckets.resize(bucket + 1, 0.0);
+    }
+    buckets[bucket] += weight;
+}
+
+size_t DistanceHistogram::bucketFor(double distance) {
+    uint64_t d = distance > 0 ? static_cast<uint64_t>(distance) : 0;
+    if (d < LINEAR_LIMIT) {
+        return static_cast<size_t>(d);
+    }
+    int octave = 63 - __builtin_clzll(d);
+    uint64_t sub = (d >> (octave - 3)) & (SUB_BUCKETS - 1);
+    return LINEAR_LIMIT + (octave - 6) * SUB_BUCKETS + sub;
+}
+
+uint64_t DistanceHistogram::bucketStart(size_t bucket) {
+    if (bucket < LINEAR_LIMIT) {
+        return bucket;
+    }
+    int octave = 6 + static_cast<int>((bucket - LINEAR_LIMIT) / SUB_BUCKETS);
+    uint64_t sub = (bucket - LINEAR_LIMIT) % SUB_BUCKETS;
+    return (uint64_t{1} << octave) + sub * (uint64_t{1} << (octave - 3));
+}
+
+MissRatioCurve DistanceHistogram::toCurve(int blockSize, uint64_t totalAccesses) const {
+    MissRatioCurve curve;
+    curve.blockSize = blockSize;
+    curve.totalAccesses = totalAccesses;
+
+    double total = coldWeight;
+    for (double w : buckets) {
+        total += w;
+    }
+
+    // A reference at distance d hits in every cache holding more than d blocks
+    double hitWeight = 0;
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        hitWeight += buckets[b];
+        double missRatio = total > 0 ? 1.0 - hitWeight / total : 1.0;
+        curve.capacities.push_back(bucketStart(b + 1));
+        curve.missRatios.push_back(std::clamp(missRatio, 0.0, 1.0));
+    }
+    return curve;
+}
+
+uint64_t StackDistanceTracker::access(uint64_t block) {
+    if (now + 1 >= tree.size()) {
+        compactTimes();
+    }
+
+    uint64_t distance = COLD;
+    auto it = lastUse.find(block);
+    if (it != lastUse.end()) {
+        distance = treePrefix(now) - treePrefix(it->second + 1);
+        treeAdd(it->second, -1);
+        it->second = now;
+    } else {
+        lastUse.emplace(block, now);
+    }
+    treeAdd(now, 1);
+    now++;
+    return distance;
+}
+
+void StackDistanceTracker::remove(uint64_t block) {
+    auto it = lastUse.find(block);
+    if (it != lastUse.end()) {
+        treeAdd(it->second, -1);
+        lastUse.erase(it);
+    }
+}
+
+void StackDistanceTracker::treeAdd(uint64_t pos, int delta) {
+    for (uint64_t i = pos + 1; i < tree.size(); i += i & (~i + 1)) {
+        tree[i] += delta;
+    }
+}
+
+uint64_t StackDistanceTracker::treePrefix(uint64_t pos) const {
+    // Number of marks at times [0, pos)
+    uint64_t sum = 0;
+    for (uint64_t i = pos; i > 0; i -= i & (~i + 1)) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+void StackDistanceTracker::compactTimes() {
+    // Renumber live last-use times densely so the tree stays O(tracked blocks)
+    std::vector<std::pair<uint64_t, uint64_t>> live;
+    live.reserve(lastUse.size());
+    for (const auto& [block, time] : lastUse) {
+        live.emplace_back(time, block);
+    }
+    std::sort(live.begin(), live.end());
+    for (size_t i = 0; i < live.size(); ++i) {
+        lastUse[live[i].second] = i;
+    }
+
+    now = live.size();
+    tree.assign(std::max<size_t>(1024, 2 * live.size() + 2), 0);
+    for (uint64_t i = 1; i < tree.size(); ++i) {
+        if (i <= now) {
+            tree[i] += 1;
+        }
+        uint64_t parent = i + (i & (~i + 1));
+        if (parent < tree.size()) {
+            tree[parent] += tree[i];
+        }
+    }
+}
+
+std::vector<uint64_t> computeStackDistances(const std::vector<uint64_t>& trace, int blockSize) {
+    int offsetBits = static_cast<int>(std::ceil(std::log2(blockSize)));
+    StackDistanceTracker tracker;
+    std::vector<uint64_t> distances(trace.size());
+    for (size_t i = 0; i < trace.size(); ++i) {
+        distances[i] = tracker.access(trace[i] >> offsetBits);
+    }
+    return distances;
+}
+
+ShardsProfiler::ShardsProfiler(int blockSize, double sampleRate, size_t maxSamples)
+    : offsetBits(static_cast<int>(std::ceil(std::log2(blockSize)))),
+      maxSamples(maxSamples),
+      threshold(static_cast<uint64_t>(sampleRate * HASH_MODULUS)) {
+    if (blockSize <= 0 || sampleRate <= 0.0 || sampleRate > 1.0) {
+        throw std::invalid_argument("Sample rate must be in (0, 1]");
+    }
+}
+
+double ShardsProfiler::getSampleRate() const {
+    return static_cast<double>(threshold) / HASH_MODULUS;
+}
+
+uint64_t ShardsProfiler::hashBlock(uint64_t block) {
+    return mixHash(block) % HASH_MODULUS;
+}
+
+void ShardsProfiler::access(uint64_t address) {
+    totalAccesses++;
+    uint64_t block = address >> offsetBits;
+    uint64_t hash = hashBlock(block);
+    if (hash >= threshold) {
+        return;
+    }
+    sampledAccesses++;
+
+    double rate = getSampleRate();
+    uint64_t distance = tracker.access(block);
+    if (distance != StackDistanceTracker::COLD) {
+        histogram.add(distance / rate, 1.0 / rate);
+    } else {
+        histogram.addCold(1.0 / rate);
+        if (maxSamples > 0) {
+            sampleHeap.emplace(hash, block);
+        }
+    }
+
+    if (maxSamples > 0 && tracker.size() > maxSamples) {
+        shrinkSample();
+    }
+}
+
+MissRatioCurve ShardsProfiler::getCurve() const {
+    // Each sampled reference was weighted by 1/R when recorded, so the
+    // normalized histogram is already an estimate over the full trace
+    return histogram.toCurve(1 << offsetBits, totalAccesses);
+}
+
+void ShardsProfiler::shrinkSample() {
+    // Lower the threshold to the largest tracked hash and drop every block at it
+    threshold = sampleHeap.top().first;
+    while (!sampleHeap.empty() && sampleHeap.top().first >= threshold) {
+        tracker.remove(sampleHeap.top().second);
+        sampleHeap.pop();
+    }
+}
+
+OptStackProfiler::OptStackProfiler(int blockSize)
+    : offsetBits(static_cast<int>(std::ceil(std::log2(blockSize)))) {
+    if (blockSize <= 0) {
+        throw std::invalid_argument("Block size must be positive");
+    }
+}
+
+void OptStackProfiler::process(const std::vector<uint64_t>& trace) {
+    // One backward pass assigns block ids and next-use times
+    std::vector<uint32_t> ids(trace.size());
+    std::vector<uint64_t> nextUseAt(trace.size());
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint64_t>> seen;
+    for (size_t i = trace.size(); i-- > 0;) {
+        auto [it, inserted] = seen.try_emplace(trace[i] >> offsetBits,
+                                               static_cast<uint32_t>(seen.size()), NEVER);
+        ids[i] = it->second.first;
+        nextUseAt[i] = it->second.second;
+        it->second.second = i;
+    }
+    seen.clear();
+    nextUse.assign(ids.empty() ? 0 : *std::max_element(ids.begin(), ids.end()) + 1, NEVER);
+    position.assign(nextUse.size(), NOT_STACKED);
+
+    for (size_t t = 0; t < trace.size(); ++t) {
+        totalAccesses++;
+        uint32_t id = ids[t];
+        nextUse[id] = nextUseAt[t];
+
+        size_t depth = position[id];
+        if (depth != NOT_STACKED) {
+            histogram.add(static_cast<double>(depth));
+        } else {
+            depth = stack.size();
+            histogram.addCold();
+            stack.push_back(id);
+            if (stack.size() > leaves) {
+                growTree();
+            }
+        }
+
+        if (depth == 0) {
+            place(0, id);
+            repairTree();
+            continue;
+        }
+
+        // Only positions left of the search point change, and the search
+        // only reads subtrees to its right, so ancestors are fixed afterwards
+        uint32_t carry = stack[0];
+        place(0, id);
+        size_t i = 1;
+        while ((i = findLater(i, depth, nextUse[carry])) < depth) {
+            uint32_t keep = carry;
+            carry = stack[i];
+            place(i, keep);
+            ++i;
+        }
+        place(depth, carry);
+        repairTree();
+    }
+}
+
+MissRatioCurve OptStackProfiler::getCurve() const {
+    return histogram.toCurve(1 << offsetBits, totalAccesses);
+}
+
+void OptStackProfiler::place(size_t pos, uint32_t id) {
+    stack[pos] = id;
+    position[id] = static_cast<uint32_t>(pos);
+    maxTree[leaves + pos] = nextUse[id];
+    dirty.push_back(leaves + pos);
+}
+
+void OptStackProfiler::repairTree() {
+    // Dirty leaves are in ascending order, so each level dedupes in one pass
+    while (!dirty.empty() && dirty.front() > 1) {
+        size_t out = 0;
+        for (size_t node : dirty) {
+            size_t parent = node / 2;
+            if (out == 0 || dirty[out - 1] != parent) {
+                maxTree[parent] = std::max(maxTree[2 * parent], maxTree[2 * parent + 1]);
+                dirty[out++] = parent;
+            }
+        }
+        dirty.resize(out);
+    }
+    dirty.clear();
+}
+
+void OptStackProfiler::growTree() {
+    leaves = std::max<size_t>(1024, leaves * 2);
+    maxTree.assign(2 * leaves, 0);
+    for (size_t i = 0; i < stack.size(); ++i) {
+        maxTree[leaves + i] = nextUse[stack[i]];
+    }
+    for (size_t node = leaves - 1; node > 0; --node) {
+        maxTree[node] = std::max(maxTree[2 * node], maxTree[2 * node + 1]);
+    }
+}
+
+size_t OptStackProfiler::findLater(size_t from, size_t to, uint64_t time) const {
+    // First position in [from, to) whose next use is later than time
+    // Chain positions are usually a few slots apart, so scan the contiguous
+    // leaves briefly before paying for a walk through the tree
+    const uint64_t* leaf = &maxTree[leaves];
+    size_t scanEnd = std::min(to, from + 32);
+    for (; from < scanEnd; ++from) {
+        if (leaf[from] > time) {
+            return from;
+        }
+    }
+    if (from >= to) {
+        return to;
+    }
+    size_t node = leaves + from;
+    if (maxTree[node] > time) {
+        return from;
+    }
+    // Climb until a right sibling subtree holds a later next use
+    while (true) {
+        if (node % 2 == 0 && maxTree[node + 1] > time) {
+            node = node + 1;
+            break;
+        }
+        node /= 2;
+        if (node <= 1) {
+            return to;
+        }
+    }
+    // Descend to the leftmost qualifying leaf
+    while (node < leaves) {
+        node = maxTree[2 * node] > time ? 2 * node : 2 * node + 1;
+    }
+    size_t pos = node - leaves;
+    return pos < to ? pos : to;
+}
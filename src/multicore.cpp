@@ -0,0 +1,210 @@
+#include "multicore.hpp"
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+struct MultiCoreSimulator::Core {
+    std::string filename;
+    TraceReader reader;
+    Cache cache;
+    std::vector<uint64_t> misses;   // waiting for the shared cache
+
+    Core(const std::string& file, int N, int B, int I, int ways, ReplacementPolicy policy,
+         const PolicyOptions& options)
+        : filename(file), reader(file), cache(N, B, I, ways, policy, 1.0, options) {}
+};
+
+namespace {
+// A core's access stream. The coroutine suspends holding its next access
+// and the time it is due; each resume issues that access and runs on to
+// the following one. Nothing runs until the first resume.
+class CoreStream {
+public:
+    struct promise_type {
+        uint64_t timestamp{0};
+        std::exception_ptr error;
+
+        CoreStream get_return_object() {
+            return CoreStream(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(uint64_t time) noexcept {
+            timestamp = time;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    explicit CoreStream(std::coroutine_handle<promise_type> h) : handle(h) {}
+    CoreStream(CoreStream&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    CoreStream(const CoreStream&) = delete;
+    CoreStream& operator=(const CoreStream&) = delete;
+    ~CoreStream() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    // Run to the next suspension; false once the trace is exhausted
+    bool step() {
+        handle.resume();
+        if (handle.promise().error) {
+            std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+        }
+        return !handle.done();
+    }
+
+    bool done() const { return handle.done(); }
+    uint64_t timestamp() const { return handle.promise().timestamp; }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Untimed traces use the access's position in its own trace as its time
+// and misses are kept only when a shared cache will take them
+CoreStream runCore(TraceReader& reader, Cache& cache, std::vector<uint64_t>* misses, bool timed) {
+    uint64_t address;
+    uint64_t timestamp = 0;
+    while (timed ? reader.next(address, timestamp) : reader.next(address)) {
+        co_yield timestamp++;
+        if (!cache.simulate(address) && misses) {
+            misses->push_back(address);
+        }
+    }
+}
+
+// Handing a round to the pool costs a wake-up and a barrier, which only pays
+// off once each core has this many accesses to run in its turn
+constexpr uint64_t MIN_POOLED_QUANTUM = 256;
+}
+
+MultiCoreSimulator::MultiCoreSimulator(int N, int B, int I, int ways, ReplacementPolicy policy,
+                                       const std::vector<std::string>& files,
+                                       const PolicyOptions& options)
+    : N(N), blockSize(B), policy(policy), options(options) {
+    if (policy == ReplacementPolicy::OPTIMAL) {
+        throw std::invalid_argument("OPTIMAL needs whole traces ahead and cannot run per core");
+    }
+    if (policyNeedsPc(policy)) {
+        throw std::invalid_argument(getPolicyName(policy) +
+                                    " needs per-access PCs, which multi-core runs do not keep");
+    }
+    if (files.empty()) {
+        throw std::invalid_argument("Multi-core simulation needs at least one trace");
+    }
+    for (const auto& file : files) {
+        cores.push_back(std::make_unique<Core>(file, N, B, I, ways, policy, options));
+    }
+}
+
+MultiCoreSimulator::~MultiCoreSimulator() = default;
+
+void MultiCoreSimulator::setSharedCache(int numSets, int ways) {
+    shared = numSets > 0 ? std::make_unique<Cache>(N, blockSize, numSets, ways, policy, 1.0, options) : nullptr;
+}
+
+void MultiCoreSimulator::run(Interleave mode, uint64_t quantum, int threads) {
+    if (quantum == 0) {
+        throw std::invalid_argument("Scheduling quantum must be positive");
+    }
+
+    std::vector<CoreStream> streams;
+    for (auto& core : cores) {
+        streams.push_back(runCore(core->reader, core->cache, shared ? &core->misses : nullptr,
+                                  mode == Interleave::TIMESTAMP));
+    }
+    // Load every core's first access
+    for (auto& stream : streams) {
+        stream.step();
+    }
+
+    auto drain = [&](Core& core) {
+        for (uint64_t address : core.misses) {
+            shared->simulate(address);
+        }
+        core.misses.clear();
+    };
+
+    if (mode == Interleave::TIMESTAMP) {
+        using Due = std::pair<uint64_t, size_t>;
+        std::priority_queue<Due, std::vector<Due>, std::greater<Due>> ready;
+        for (size_t c = 0; c < streams.size(); ++c) {
+            if (!streams[c].done()) {
+                ready.emplace(streams[c].timestamp(), c);
+            }
+        }
+        while (!ready.empty()) {
+            size_t c = ready.top().second;
+            ready.pop();
+            bool more = streams[c].step();
+            if (shared) {
+                drain(*cores[c]);
+            }
+            if (more) {
+                ready.emplace(streams[c].timestamp(), c);
+            }
+        }
+        return;
+    }
+
+    std::vector<size_t> live;
+    for (size_t c = 0; c < streams.size(); ++c) {
+        if (!streams[c].done()) {
+            live.push_back(c);
+        }
+    }
+    auto runQuantum = [&](size_t c) {
+        for (uint64_t q = 0; q < quantum && streams[c].step(); ++q) {
+        }
+    };
+
+    std::optional<ThreadPool> pool;
+    if (threads > 1 && live.size() > 1 && quantum >= MIN_POOLED_QUANTUM) {
+        pool.emplace(std::min<int>(threads, static_cast<int>(live.size())));
+    }
+    while (!live.empty()) {
+        if (pool) {
+            for (size_t c : live) {
+                pool->submit([&, c] { runQuantum(c); });
+            }
+            pool->wait();
+        } else {
+            for (size_t c : live) {
+                runQuantum(c);
+            }
+        }
+        if (shared) {
+            for (size_t c : live) {
+                drain(*cores[c]);
+            }
+        }
+        live.erase(std::remove_if(live.begin(), live.end(),
+                                  [&](size_t c) { return streams[c].done(); }),
+                   live.end());
+    }
+}
+
+const std::string& MultiCoreSimulator::getCoreFile(size_t core) const {
+    return cores.at(core)->filename;
+}
+
+const CacheStats& MultiCoreSimulator::getCoreStats(size_t core) const {
+    return cores.at(core)->cache.getStats();
+}
+
+const CacheStats& MultiCoreSimulator::getSharedStats() const {
+    if (!shared) {
+        throw std::logic_error("No shared cache configured");
+    }
+    return shared->getStats();
+}
@@ -0,0 +1,65 @@
+#include "next_use.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+// Chunks smaller than this cost more in thread startup than they save
+constexpr size_t MIN_CHUNK = 1 << 16;
+
+template <typename Fn>
+void runChunks(int count, Fn fn) {
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (int c = 1; c < count; ++c) {
+        workers.emplace_back(fn, c);
+    }
+    fn(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+}
+
+std::vector<uint64_t> computeNextUse(const std::vector<uint64_t>& trace, int blockSize, int threads) {
+    int offsetBits = static_cast<int>(std::log2(blockSize));
+    size_t n = trace.size();
+    int chunks = static_cast<int>(std::clamp<size_t>(n / MIN_CHUNK, 1, std::max(threads, 1)));
+    auto bounds = [&](int c) { return std::make_pair(n * c / chunks, n * (c + 1) / chunks); };
+
+    std::vector<uint64_t> nextUse(n, NEVER_USED);
+    std::vector<std::unordered_map<uint64_t, uint64_t>> firstSeen(chunks);
+    std::vector<std::vector<uint64_t>> boundary(chunks);
+
+    // Backward scan: the block's earliest position so far is the next use
+    runChunks(chunks, [&](int c) {
+        auto [begin, end] = bounds(c);
+        auto& seen = firstSeen[c];
+        for (size_t i = end; i-- > begin;) {
+            auto [it, inserted] = seen.try_emplace(trace[i] >> offsetBits, i);
+            if (inserted) {
+                boundary[c].push_back(i);
+            } else {
+                nextUse[i] = it->second;
+                it->second = i;
+            }
+        }
+    });
+
+    // Each block's last access in a chunk takes its first appearance in the
+    // nearest later chunk that references it
+    runChunks(chunks, [&](int c) {
+        for (uint64_t i : boundary[c]) {
+            uint64_t block = trace[i] >> offsetBits;
+            for (int later = c + 1; later < chunks; ++later) {
+                auto it = firstSeen[later].find(block);
+                if (it != firstSeen[later].end()) {
+                    nextUse[i] = it->second;
+                    break;
+                }
+            }
+        }
+    });
+    return nextUse;
+}
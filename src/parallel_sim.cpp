@@ -0,0 +1,200 @@
+#include "parallel_sim.hpp"
+#include "address_parser.hpp"
+#include "cache.hpp"
+#include "cache_set.hpp"
+#include "next_use.hpp"
+#include "shadow_cache.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+// Run fn(worker) on `count` threads and wait for all of them
+template <typename Fn>
+void runWorkers(int count, Fn fn) {
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (int w = 0; w < count; ++w) {
+        workers.emplace_back(fn, w);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::pair<size_t, size_t> chunkBounds(size_t total, int chunks, int chunk) {
+    return {total * chunk / chunks, total * (chunk + 1) / chunks};
+}
+
+// Bring an empty shadow to its state just before trace position `start`:
+// the accesses before it whose block is not referenced again until `start`
+// or later are the last uses of their blocks, and the most recent
+// `capacity` of them, replayed oldest first, are exactly its contents
+void warmShadow(ShadowLRU& shadow, const std::vector<uint64_t>& trace,
+                const std::vector<uint64_t>& nextUse, const AddressParser& parser,
+                size_t start, size_t capacity) {
+    std::vector<uint64_t> recent;
+    for (size_t i = start; i-- > 0 && recent.size() < capacity;) {
+        if (nextUse[i] >= start) {
+            recent.push_back(parser.blockAddress(trace[i]));
+        }
+    }
+    for (auto it = recent.rbegin(); it != recent.rend(); ++it) {
+        shadow.access(*it);
+    }
+}
+}
+
+ShardedSimulator::ShardedSimulator(int N, int B, int I, int ways, ReplacementPolicy policy, int threads,
+                                   const PolicyOptions& options)
+    : N(N),
+      blockSize(Cache::roundToPowerOfTwo(B)),
+      numSets(Cache::roundToPowerOfTwo(I)),
+      ways(ways),
+      policy(policy),
+      options(options),
+      threads(threads) {
+    if (N <= 0 || blockSize <= 0 || numSets <= 0 || ways <= 0 || threads <= 0) {
+        throw std::invalid_argument("Cache parameters and thread count must be positive");
+    }
+    if (policy == ReplacementPolicy::OPTIMAL) {
+        throw std::invalid_argument("OPTIMAL needs whole-trace state and cannot be sharded");
+    }
+    if (policySharesState(policy)) {
+        throw std::invalid_argument(getPolicyName(policy) +
+                                    " shares state across sets and cannot be sharded");
+    }
+}
+
+CacheStats ShardedSimulator::run(const std::vector<uint64_t>& trace) {
+    int shards = std::min(threads, numSets);
+    std::vector<size_t> order;
+    std::vector<size_t> shardStart;
+    partition(trace, shards, order, shardStart);
+
+    // Per-access flags written by disjoint workers: a non-cold miss in the
+    // real cache
+    std::vector<uint8_t> warmMiss(trace.size(), 0);
+    std::vector<ShardResult> results(shards);
+
+    runWorkers(shards, [&](int worker) {
+        auto [firstSet, lastSet] = chunkBounds(numSets, shards, worker);
+        results[worker] = simulateShard(trace, order.data() + shardStart[worker],
+                                        order.data() + shardStart[worker + 1],
+                                        static_cast<int>(firstSet), static_cast<int>(lastSet),
+                                        warmMiss);
+    });
+
+    CacheStats stats;
+    stats.setConfiguration(ways, policy);
+    for (const auto& result : results) {
+        stats.hits += result.hits;
+        stats.misses += result.misses;
+        stats.coldMisses += result.coldMisses;
+    }
+    stats.totalAccesses = trace.size();
+
+    // The shadow runs in trace chunks, each warmed to the state a serial
+    // shadow would have at its start, and counts conflicts as it goes
+    std::vector<uint64_t> nextUse = computeNextUse(trace, blockSize, threads);
+    size_t capacity = static_cast<size_t>(numSets) * ways;
+    AddressParser parser(N, blockSize, numSets);
+    std::vector<uint64_t> conflicts(threads, 0);
+    runWorkers(threads, [&](int worker) {
+        auto [begin, end] = chunkBounds(trace.size(), threads, worker);
+        ShadowLRU shadow(capacity);
+        warmShadow(shadow, trace, nextUse, parser, begin, capacity);
+        uint64_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            count += warmMiss[i] & static_cast<uint8_t>(shadow.access(parser.blockAddress(trace[i])));
+        }
+        conflicts[worker] = count;
+    });
+    for (uint64_t count : conflicts) {
+        stats.conflictMisses += count;
+    }
+    stats.capacityMisses = stats.misses - stats.coldMisses - stats.conflictMisses;
+    return stats;
+}
+
+void ShardedSimulator::partition(const std::vector<uint64_t>& trace, int shards,
+                                 std::vector<size_t>& order, std::vector<size_t>& shardStart) const {
+    // Shard s owns sets [s*numSets/shards, (s+1)*numSets/shards)
+    AddressParser parser(N, blockSize, numSets);
+    std::vector<int> shardOfSet(numSets);
+    for (int s = 0; s < shards; ++s) {
+        auto [first, last] = chunkBounds(numSets, shards, s);
+        std::fill(shardOfSet.begin() + first, shardOfSet.begin() + last, s);
+    }
+
+    // Stable counting sort: each chunk counts its shard sizes, prefix sums
+    // over (shard, chunk) give every chunk its output ranges, then scatter
+    int chunks = threads;
+    std::vector<std::vector<size_t>> counts(chunks, std::vector<size_t>(shards, 0));
+    runWorkers(chunks, [&](int chunk) {
+        auto [begin, end] = chunkBounds(trace.size(), chunks, chunk);
+        for (size_t i = begin; i < end; ++i) {
+            counts[chunk][shardOfSet[parser.setIndex(trace[i])]]++;
+        }
+    });
+
+    shardStart.assign(shards + 1, 0);
+    size_t offset = 0;
+    for (int s = 0; s < shards; ++s) {
+        shardStart[s] = offset;
+        for (int c = 0; c < chunks; ++c) {
+            size_t count = counts[c][s];
+            counts[c][s] = offset;
+            offset += count;
+        }
+    }
+    shardStart[shards] = offset;
+
+    order.resize(trace.size());
+    runWorkers(chunks, [&](int chunk) {
+        auto [begin, end] = chunkBounds(trace.size(), chunks, chunk);
+        auto& cursor = counts[chunk];
+        for (size_t i = begin; i < end; ++i) {
+            order[cursor[shardOfSet[parser.setIndex(trace[i])]]++] = i;
+        }
+    });
+}
+
+ShardedSimulator::ShardResult ShardedSimulator::simulateShard(
+    const std::vector<uint64_t>& trace, const size_t* begin, const size_t* end,
+    int firstSet, int lastSet, std::vector<uint8_t>& warmMiss) const {
+    // Blocks map to exactly one set, so a per-shard parser tracks cold
+    // misses exactly as the serial parser would
+    AddressParser parser(N, blockSize, numSets);
+    return withPolicy(policy, [&](auto type) -> ShardResult {
+        using Policy = typename decltype(type)::type;
+        if constexpr (SharedStatePolicy<Policy>) {
+            throw std::logic_error("policies with shared state are never sharded");
+        } else {
+            std::vector<CacheSet<Policy>> sets;
+            sets.reserve(lastSet - firstSet);
+            for (int i = firstSet; i < lastSet; ++i) {
+                sets.emplace_back(ways, options, static_cast<size_t>(i));
+            }
+
+            ShardResult result;
+            for (const size_t* it = begin; it != end; ++it) {
+                auto parsed = parser.parseAddress(trace[*it]);
+                CacheSet<Policy>& set = sets[parsed.index - firstSet];
+                size_t way;
+                if (set.lookup(parsed.tag, way)) {
+                    result.hits++;
+                    continue;
+                }
+                set.fill(set.findVictim(parsed.tag), parsed.tag);
+                result.misses++;
+                if (parsed.isColdAccess) {
+                    result.coldMisses++;
+                } else {
+                    warmMiss[*it] = 1;
+                }
+            }
+            return result;
+        }
+    });
+}
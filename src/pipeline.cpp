@@ -0,0 +1,139 @@
+#include "pipeline.hpp"
+#include "spsc_ring.hpp"
+#include "trace.hpp"
+#include "visualization.hpp"
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+constexpr size_t ADDRESS_RING = 4096;
+constexpr size_t RESULT_RING = 1024;
+
+// First exception raised by any stage; the others are unwound by cancelling
+class StageErrors {
+public:
+    void record() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!first) {
+            first = std::current_exception();
+        }
+    }
+
+    void rethrow() {
+        if (first) {
+            std::rethrow_exception(first);
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::exception_ptr first;
+};
+
+std::vector<TraceAccess> loadUniqueTrace(const std::string& filename) {
+    TraceReader reader(filename);
+    std::unordered_set<uint64_t> seen;
+    std::vector<TraceAccess> trace;
+    TraceAccess access;
+    while (reader.next(access)) {
+        if (seen.insert(access.address).second) {
+            trace.push_back(access);
+        }
+    }
+    return trace;
+}
+}
+
+std::vector<Cache::AccessResult> runTablePipeline(Cache& cache, const std::string& filename,
+                                                  bool keepResults) {
+    // OPTIMAL needs the whole trace before the first access
+    std::vector<TraceAccess> preloaded;
+    bool lookahead = cache.getStats().policy == ReplacementPolicy::OPTIMAL;
+    if (lookahead) {
+        preloaded = loadUniqueTrace(filename);
+        std::vector<uint64_t> addresses(preloaded.size());
+        for (size_t i = 0; i < preloaded.size(); ++i) {
+            addresses[i] = preloaded[i].address;
+        }
+        cache.setOptimalTrace(addresses);
+    }
+    // Open in this thread so a missing file fails before any output
+    std::optional<TraceReader> reader;
+    if (!lookahead) {
+        reader.emplace(filename);
+        ReplacementPolicy policy = cache.getStats().policy;
+        if (policyNeedsPc(policy)) {
+            reader->requirePc(getPolicyName(policy));
+        }
+    }
+
+    SpscRing<TraceAccess> addresses(ADDRESS_RING);
+    SpscRing<Cache::AccessResult> results(RESULT_RING);
+    StageErrors errors;
+    auto abort = [&] {
+        errors.record();
+        addresses.cancel();
+        results.cancel();
+    };
+
+    std::thread readerThread([&] {
+        try {
+            if (lookahead) {
+                for (const TraceAccess& access : preloaded) {
+                    if (!addresses.push(access)) {
+                        return;
+                    }
+                }
+            } else {
+                std::unordered_set<uint64_t> seen;
+                TraceAccess access;
+                while (reader->next(access)) {
+                    if (seen.insert(access.address).second && !addresses.push(access)) {
+                        return;
+                    }
+                }
+            }
+            addresses.close();
+        } catch (...) {
+            abort();
+        }
+    });
+
+    std::vector<Cache::AccessResult> kept;
+    CacheVisualizer::TableLayout layout = CacheVisualizer::tableLayout(cache);
+    CacheVisualizer::printTableHeader(std::cout, cache.getStats(), layout);
+    std::thread printerThread([&] {
+        try {
+            Cache::AccessResult result;
+            while (results.pop(result)) {
+                CacheVisualizer::printTableRow(std::cout, result, layout);
+                if (keepResults) {
+                    kept.push_back(std::move(result));
+                }
+            }
+        } catch (...) {
+            abort();
+        }
+    });
+
+    try {
+        TraceAccess access;
+        while (addresses.pop(access)) {
+            if (!results.push(cache.access(access.address, access.pc))) {
+                break;
+            }
+        }
+        results.close();
+    } catch (...) {
+        abort();
+    }
+
+    readerThread.join();
+    printerThread.join();
+    errors.rethrow();
+    return kept;
+}
@@ -0,0 +1,67 @@
+#include "plugin_policy.hpp"
+#include <cstddef>
+#include <dlfcn.h>
+#include <stdexcept>
+
+PluginSets::PluginSets(size_t numSets, const PolicyOptions& options)
+    : path(options.pluginPath), numSets(numSets) {
+    if (path.empty()) {
+        throw std::invalid_argument("Name the policy plugin's shared object with -p plugin:PATH");
+    }
+    library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!library) {
+        throw std::runtime_error("Could not load policy plugin: " + std::string(dlerror()));
+    }
+    auto entry = reinterpret_cast<cachesim_policy_entry>(dlsym(library, "cachesim_policy_v1"));
+    policy = entry ? entry() : nullptr;
+    if (!policy) {
+        dlclose(library);
+        throw std::runtime_error("Policy plugin does not export cachesim_policy_v1: " + path);
+    }
+    if (policy->abi_version != CACHESIM_POLICY_ABI_VERSION || !policy->state_size ||
+        !policy->init_sets || !policy->on_events || !policy->choose_victim) {
+        dlclose(library);
+        throw std::runtime_error("Policy plugin has an incompatible ABI: " + path);
+    }
+    pending.reserve(BATCH);
+}
+
+PluginSets::~PluginSets() {
+    dlclose(library);
+}
+
+void PluginSets::attach(int ways) {
+    if (sets.ways != 0) {
+        if (sets.ways != static_cast<uint32_t>(ways)) {
+            throw std::logic_error("All sets of a cache must have the same ways");
+        }
+        return;
+    }
+    sets.ways = static_cast<uint32_t>(ways);
+    // Round up so every set's state is aligned for any type; the block
+    // itself comes from operator new, which aligns at least this far
+    constexpr size_t align = alignof(std::max_align_t);
+    sets.stride = (policy->state_size(sets.ways) + align - 1) / align * align;
+    sets.count = static_cast<uint32_t>(numSets);
+    state.assign(sets.stride * numSets, 0);
+    sets.state = state.data();
+    policy->init_sets(&sets, 0, sets.count);
+}
+
+size_t PluginSets::victim(size_t set, uint64_t tag, uint64_t pc) {
+    flush();
+    uint32_t way = policy->choose_victim(&sets, static_cast<uint32_t>(set), tag, pc);
+    if (way >= sets.ways) {
+        throw std::runtime_error("Policy plugin " + std::string(policy->name ? policy->name : path) +
+                                 " chose way " + std::to_string(way) + " of a " +
+                                 std::to_string(sets.ways) + "-way set");
+    }
+    return way;
+}
+
+void PluginSets::flush() {
+    if (!pending.empty()) {
+        policy->on_events(&sets, pending.data(), pending.size());
+        pending.clear();
+    }
+}
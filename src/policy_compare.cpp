@@ -0,0 +1,73 @@
+#include "policy_compare.hpp"
+#include "cache.hpp"
+#include "next_use.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+PolicyComparison::PolicyComparison(int N, int B, int I, int ways,
+                                   const std::vector<ReplacementPolicy>& policies,
+                                   const PolicyOptions& options)
+    : blockSize(Cache::roundToPowerOfTwo(B)),
+      numSets(Cache::roundToPowerOfTwo(I)),
+      policies(policies),
+      parser(N, blockSize, numSets),
+      shadow(static_cast<size_t>(numSets) * std::max(ways, 1)) {
+    if (N <= 0 || blockSize <= 0 || numSets <= 0 || ways <= 0) {
+        throw std::invalid_argument("Cache parameters must be positive");
+    }
+    if (policies.empty()) {
+        throw std::invalid_argument("Policy comparison needs at least one policy");
+    }
+
+    for (ReplacementPolicy policy : policies) {
+        sets.push_back(makeSetArray(policy, numSets, ways, options));
+    }
+    stats.resize(policies.size());
+    for (size_t p = 0; p < policies.size(); ++p) {
+        stats[p].setConfiguration(ways, policies[p]);
+    }
+}
+
+void PolicyComparison::access(uint64_t address, uint64_t pc) {
+    auto parsed = parser.parseAddress(address, pc);
+    bool shadowHit = shadow.access(parsed.blockAddress);
+
+    for (size_t p = 0; p < policies.size(); ++p) {
+        AccessInfo info;
+        info.pc = parsed.pc;
+        if (sets[p]->needsNextUse()) {
+            if (position >= nextUse.size()) {
+                throw std::runtime_error("OPTIMAL needs the trace before simulating past its end");
+            }
+            info.nextUse = nextUse[position];
+        }
+        bool hit = sets[p]->access(parsed.index, parsed.tag, info).hit;
+        stats[p].recordOutcome(hit, !hit && parsed.isColdAccess,
+                               !hit && !parsed.isColdAccess && shadowHit);
+    }
+    position++;
+}
+
+void PolicyComparison::setOptimalTrace(const std::vector<uint64_t>& trace) {
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    nextUse = computeNextUse(trace, blockSize, threads);
+    position = 0;
+}
+
+std::vector<ReplacementPolicy> parsePolicyList(const std::string& list) {
+    std::vector<ReplacementPolicy> policies;
+    std::stringstream ss(list);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        if (!name.empty()) {
+            policies.push_back(parsePolicyName(name));
+        }
+    }
+    if (policies.empty()) {
+        throw std::invalid_argument("No policies given: " + list);
+    }
+    return policies;
+}
@@ -0,0 +1,236 @@
+#include "process_sweep.hpp"
+#include "cache.hpp"
+#include "next_use.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+// One finished configuration, as sent from a worker to the coordinator. A
+// configuration that threw carries the error's text instead of counters.
+struct ResultRecord {
+    uint64_t gridIndex;
+    uint64_t totalAccesses;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t coldMisses;
+    uint64_t conflictMisses;
+    uint64_t capacityMisses;
+    char error[256];   // empty on success
+};
+static_assert(sizeof(ResultRecord) <= PIPE_BUF, "records must be written atomically");
+
+// Anonymous shared mapping, unmapped on scope exit
+class SharedMapping {
+public:
+    explicit SharedMapping(size_t bytes) : bytes(std::max<size_t>(bytes, 1)) {
+        data = mmap(nullptr, this->bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error(std::string("Could not map shared memory: ") + std::strerror(errno));
+        }
+    }
+    ~SharedMapping() { munmap(data, bytes); }
+
+    SharedMapping(const SharedMapping&) = delete;
+    SharedMapping& operator=(const SharedMapping&) = delete;
+
+    void makeReadOnly() { mprotect(data, bytes, PROT_READ); }
+    [[nodiscard]] void* get() const { return data; }
+
+private:
+    size_t bytes;
+    void* data;
+};
+
+bool writeAll(int fd, const void* buffer, size_t size) {
+    const char* bytes = static_cast<const char*>(buffer);
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+// nextUse is the shared look-ahead for OPTIMAL at this block size, else null
+ResultRecord simulateConfig(int N, const SweepConfig& config, const PolicyOptions& options,
+                            const uint64_t* trace, const uint64_t* nextUse, size_t size,
+                            size_t gridIndex) {
+    Cache cache(N, config.blockSize, config.numSets, config.ways, config.policy, 1.0, options);
+    if (nextUse) {
+        cache.setNextUse(std::span<const uint64_t>(nextUse, size));
+    }
+    for (size_t i = 0; i < size; ++i) {
+        cache.simulate(trace[i]);
+    }
+    const CacheStats& stats = cache.getStats();
+    return {gridIndex, stats.totalAccesses, stats.hits, stats.misses,
+            stats.coldMisses, stats.conflictMisses, stats.capacityMisses, {}};
+}
+
+// Worker process body; never returns. A configuration that throws is
+// reported with its error and ends the worker.
+[[noreturn]] void workerMain(int N, const std::vector<SweepConfig>& grid,
+                             const PolicyOptions& options, const uint64_t* trace,
+                             const std::map<int, const uint64_t*>& nextUse, size_t size,
+                             std::atomic<uint64_t>* nextConfig, int resultFd) {
+    uint64_t i;
+    while ((i = nextConfig->fetch_add(1)) < grid.size()) {
+        ResultRecord record{};
+        bool failed = false;
+        try {
+            auto times = nextUse.find(Cache::roundToPowerOfTwo(grid[i].blockSize));
+            record = simulateConfig(N, grid[i], options, trace,
+                                    grid[i].policy == ReplacementPolicy::OPTIMAL ? times->second : nullptr,
+                                    size, i);
+        } catch (const std::exception& e) {
+            record.gridIndex = i;
+            std::strncpy(record.error, e.what(), sizeof(record.error) - 1);
+            failed = true;
+        } catch (...) {
+            _exit(1);
+        }
+        if (!writeAll(resultFd, &record, sizeof(record)) || failed) {
+            _exit(1);
+        }
+    }
+    _exit(0);
+}
+}
+
+std::vector<SweepResult> runProcessSweep(int N, const std::vector<SweepConfig>& grid,
+                                         const std::vector<uint64_t>& trace, int processes,
+                                         const PolicyOptions& options) {
+    if (processes <= 0) {
+        throw std::invalid_argument("Process count must be positive");
+    }
+    processes = std::max(1, std::min<int>(processes, static_cast<int>(grid.size())));
+
+    // Validate every configuration here, where errors can still be reported
+    std::vector<SweepResult> results(grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        results[i].config = {Cache::roundToPowerOfTwo(grid[i].blockSize),
+                             Cache::roundToPowerOfTwo(grid[i].numSets), grid[i].ways, grid[i].policy};
+        AddressParser validate(N, results[i].config.blockSize, results[i].config.numSets);
+        if (grid[i].ways <= 0) {
+            throw std::invalid_argument("Cache parameters must be positive");
+        }
+        if (policyNeedsPc(grid[i].policy)) {
+            throw std::invalid_argument(getPolicyName(grid[i].policy) +
+                                        " needs per-access PCs, which sweeps do not keep");
+        }
+    }
+
+    // OPTIMAL's look-ahead is computed once per block size, here, and shared
+    // read-only with the trace, so workers neither copy nor recompute it
+    std::map<int, size_t> lookahead;
+    for (const SweepResult& result : results) {
+        if (result.config.policy == ReplacementPolicy::OPTIMAL) {
+            lookahead.emplace(result.config.blockSize, lookahead.size() + 1);
+        }
+    }
+    SharedMapping traceMapping((lookahead.size() + 1) * trace.size() * sizeof(uint64_t));
+    auto* shared = static_cast<uint64_t*>(traceMapping.get());
+    std::copy(trace.begin(), trace.end(), shared);
+    std::map<int, const uint64_t*> nextUse;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (const auto& [blockSize, slot] : lookahead) {
+        auto times = computeNextUse(trace, blockSize, threads);
+        std::copy(times.begin(), times.end(), shared + slot * trace.size());
+        nextUse.emplace(blockSize, shared + slot * trace.size());
+    }
+    traceMapping.makeReadOnly();
+    SharedMapping counterMapping(sizeof(std::atomic<uint64_t>));
+    auto* nextConfig = new (counterMapping.get()) std::atomic<uint64_t>(0);
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw std::runtime_error(std::string("Could not create pipe: ") + std::strerror(errno));
+    }
+
+    std::vector<pid_t> workers;
+    for (int p = 0; p < processes; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            workerMain(N, grid, options, shared, nextUse, trace.size(), nextConfig, fds[1]);
+        }
+        if (pid < 0) {
+            break;
+        }
+        workers.push_back(pid);
+    }
+    close(fds[1]);
+
+    // Records arrive whole since each is at most PIPE_BUF bytes; the pipe
+    // reaches end of file once every worker has exited
+    std::vector<bool> received(grid.size(), false);
+    std::string error;
+    ResultRecord record;
+    size_t filled = 0;
+    while (true) {
+        ssize_t got = read(fds[0], reinterpret_cast<char*>(&record) + filled, sizeof(record) - filled);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        filled += got;
+        if (filled < sizeof(record)) {
+            continue;
+        }
+        filled = 0;
+        if (record.error[0] != '\0') {
+            if (error.empty()) {
+                record.error[sizeof(record.error) - 1] = '\0';
+                error = record.error;
+            }
+            continue;
+        }
+        CacheStats& stats = results[record.gridIndex].stats;
+        stats.setConfiguration(grid[record.gridIndex].ways, grid[record.gridIndex].policy);
+        stats.totalAccesses = record.totalAccesses;
+        stats.hits = record.hits;
+        stats.misses = record.misses;
+        stats.coldMisses = record.coldMisses;
+        stats.conflictMisses = record.conflictMisses;
+        stats.capacityMisses = record.capacityMisses;
+        received[record.gridIndex] = true;
+    }
+    close(fds[0]);
+
+    bool workersFailed = workers.empty();
+    for (pid_t pid : workers) {
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            workersFailed = true;
+        }
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    if (workersFailed || std::find(received.begin(), received.end(), false) != received.end()) {
+        throw std::runtime_error("A sweep worker process failed");
+    }
+    return results;
+}
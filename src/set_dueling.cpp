@@ -0,0 +1,32 @@
+#include "set_dueling.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+SetDuel::SetDuel(size_t numSets, const PolicyOptions& options) {
+    if (options.pselBits < 1 || options.pselBits > 31) {
+        throw std::invalid_argument("PSEL width must be between 1 and 31 bits");
+    }
+    pselMax = (uint32_t{1} << options.pselBits) - 1;
+    midpoint = uint32_t{1} << (options.pselBits - 1);
+    psel = midpoint;
+
+    // At most one leader pair per four sets, so every constituency keeps at
+    // least two followers for PSEL to steer; a cache of fewer than four sets
+    // has no leaders, and all its sets stay with A since PSEL never moves
+    size_t leaders = std::min<size_t>(options.duelLeaders, numSets / 4);
+    stride = leaders > 0 ? numSets / leaders : 0;
+}
+
+SetDuel::Role SetDuel::role(size_t set) const {
+    if (stride == 0) {
+        return Role::FOLLOWER;
+    }
+    size_t offset = set % stride;
+    if (offset == 0) {
+        return Role::LEADER_A;
+    }
+    if (offset == stride / 2) {
+        return Role::LEADER_B;
+    }
+    return Role::FOLLOWER;
+}
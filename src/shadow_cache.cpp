@@ -0,0 +1,52 @@
+#include "shadow_cache.hpp"
+#include <stdexcept>
+
+ShadowLRU::ShadowLRU(size_t capacity) : capacity(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("Shadow cache capacity must be positive");
+    }
+    nodes.reserve(capacity);
+    index.reserve(capacity);
+}
+
+bool ShadowLRU::access(uint64_t block) {
+    auto it = index.find(block);
+    if (it != index.end()) {
+        if (it->second != head) {
+            unlink(it->second);
+            pushFront(it->second);
+        }
+        return true;
+    }
+
+    uint32_t node;
+    if (nodes.size() < capacity) {
+        node = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({block, NONE, NONE});
+    } else {
+        // Recycle the LRU node for the incoming block
+        node = tail;
+        unlink(node);
+        index.erase(nodes[node].block);
+        nodes[node].block = block;
+    }
+    index.emplace(block, node);
+    pushFront(node);
+    return false;
+}
+
+void ShadowLRU::unlink(uint32_t node) {
+    Node& n = nodes[node];
+    if (n.prev != NONE) nodes[n.prev].next = n.next;
+    else head = n.next;
+    if (n.next != NONE) nodes[n.next].prev = n.prev;
+    else tail = n.prev;
+}
+
+void ShadowLRU::pushFront(uint32_t node) {
+    nodes[node].prev = NONE;
+    nodes[node].next = head;
+    if (head != NONE) nodes[head].prev = node;
+    head = node;
+    if (tail == NONE) tail = node;
+}
@@ -0,0 +1,333 @@
+#include "sweep.hpp"
+#include "cache.hpp"
+#include "lane_sim.hpp"
+#include "mrc.hpp"
+#include "next_use.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream ss(text);
+    std::string part;
+    while (std::getline(ss, part, separator)) {
+        part.erase(std::remove_if(part.begin(), part.end(),
+                                  [](unsigned char c) { return std::isspace(c); }),
+                   part.end());
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+// Per block size state shared by every sharded job of that block size
+struct BlockSizeGroup {
+    std::vector<std::pair<double, size_t>> jobs;   // (cost per shard, grid index)
+    std::map<int, std::vector<size_t>> laneJobs;    // grid indices by ways
+    std::vector<uint64_t> distances;                // LRU stack distance per access
+    std::vector<size_t> order;                      // trace positions grouped by shard
+    std::vector<size_t> shardStart;
+};
+
+struct ShardResult {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t coldMisses{0};
+    uint64_t conflictMisses{0};
+};
+
+// Relative simulation cost, used only to order tasks
+double estimateCost(const SweepConfig& config, size_t accesses) {
+    double perAccess = 1.0 + config.ways;
+    if (config.policy == ReplacementPolicy::OPTIMAL) {
+        perAccess *= 4.0;
+    }
+    return perAccess * static_cast<double>(accesses);
+}
+
+// Stable counting sort of trace positions by block number modulo shards
+void partitionTrace(const std::vector<uint64_t>& trace, int blockSize, int shards,
+                    std::vector<size_t>& order, std::vector<size_t>& shardStart) {
+    int offsetBits = static_cast<int>(std::log2(blockSize));
+    uint64_t mask = static_cast<uint64_t>(shards) - 1;
+    shardStart.assign(shards + 1, 0);
+    for (uint64_t address : trace) {
+        shardStart[((address >> offsetBits) & mask) + 1]++;
+    }
+    for (int s = 0; s < shards; ++s) {
+        shardStart[s + 1] += shardStart[s];
+    }
+    std::vector<size_t> cursor(shardStart.begin(), shardStart.end() - 1);
+    order.resize(trace.size());
+    for (size_t i = 0; i < trace.size(); ++i) {
+        order[cursor[(trace[i] >> offsetBits) & mask]++] = i;
+    }
+}
+
+// Replay one shard's accesses in trace order. Sets never interact, so the
+// shard's hits match a whole-cache run. A miss is cold on a block's first
+// reference, and a conflict miss when its stack distance is below the
+// capacity in blocks, i.e. a fully-associative LRU cache would have hit.
+ShardResult simulateShard(const SweepConfig& config, const std::vector<uint64_t>& trace,
+                          const BlockSizeGroup& group, const size_t* begin, const size_t* end,
+                          int shard, int shardBits, const PolicyOptions& options) {
+    int offsetBits = static_cast<int>(std::log2(config.blockSize));
+    int indexBits = static_cast<int>(std::log2(config.numSets));
+    uint64_t capacity = static_cast<uint64_t>(config.numSets) * config.ways;
+
+    return withPolicy(config.policy, [&](auto type) -> ShardResult {
+        using Policy = typename decltype(type)::type;
+        if constexpr (SharedStatePolicy<Policy>) {
+            throw std::logic_error("policies with shared state are never sharded");
+        } else {
+            std::vector<CacheSet<Policy>> sets;
+            sets.reserve(config.numSets >> shardBits);
+            // Slot i holds the set whose index is i above the shard's bits
+            for (int i = 0; i < (config.numSets >> shardBits); ++i) {
+                sets.emplace_back(config.ways, options,
+                                  (static_cast<size_t>(i) << shardBits) | static_cast<size_t>(shard));
+            }
+
+            ShardResult result;
+            for (const size_t* it = begin; it != end; ++it) {
+                uint64_t block = trace[*it] >> offsetBits;
+                uint64_t index = block & ((uint64_t{1} << indexBits) - 1);
+                uint64_t tag = block >> indexBits;
+                CacheSet<Policy>& set = sets[index >> shardBits];
+                size_t way;
+                if (set.lookup(tag, way)) {
+                    result.hits++;
+                    continue;
+                }
+                set.fill(set.findVictim(tag), tag);
+                result.misses++;
+                uint64_t distance = group.distances[*it];
+                if (distance == StackDistanceTracker::COLD) {
+                    result.coldMisses++;
+                } else if (distance < capacity) {
+                    result.conflictMisses++;
+                }
+            }
+            return result;
+        }
+    });
+}
+
+std::vector<int> parseInts(const std::string& key, const std::vector<std::string>& values) {
+    std::vector<int> result;
+    for (const auto& value : values) {
+        size_t used = 0;
+        int parsed = 0;
+        try {
+            parsed = std::stoi(value, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used != value.size() || parsed <= 0) {
+            throw std::invalid_argument("Invalid sweep value for " + key + ": " + value);
+        }
+        result.push_back(parsed);
+    }
+    return result;
+}
+}
+
+std::vector<SweepConfig> parseSweepSpec(const std::string& spec, const SweepConfig& defaults) {
+    std::vector<int> blockSizes{defaults.blockSize};
+    std::vector<int> setCounts{defaults.numSets};
+    std::vector<int> wayCounts{defaults.ways};
+    std::vector<ReplacementPolicy> policies{defaults.policy};
+
+    for (const auto& field : split(spec, ';')) {
+        auto eq = field.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Sweep field must look like key=v1,v2: " + field);
+        }
+        std::string key = field.substr(0, eq);
+        auto values = split(field.substr(eq + 1), ',');
+        if (values.empty()) {
+            throw std::invalid_argument("Sweep field has no values: " + field);
+        }
+
+        if (key == "B") {
+            blockSizes = parseInts(key, values);
+        } else if (key == "I") {
+            setCounts = parseInts(key, values);
+        } else if (key == "w") {
+            wayCounts = parseInts(key, values);
+        } else if (key == "p") {
+            policies.clear();
+            for (const auto& value : values) {
+                policies.push_back(parsePolicyName(value));
+            }
+        } else {
+            throw std::invalid_argument("Unknown sweep key (use B, I, w or p): " + key);
+        }
+    }
+
+    std::vector<SweepConfig> grid;
+    for (int blockSize : blockSizes) {
+        for (int numSets : setCounts) {
+            for (int ways : wayCounts) {
+                for (ReplacementPolicy policy : policies) {
+                    grid.push_back({blockSize, numSets, ways, policy});
+                }
+            }
+        }
+    }
+    return grid;
+}
+
+std::vector<SweepResult> runSweep(int N, const std::vector<SweepConfig>& grid,
+                                  const std::vector<uint64_t>& trace, int threads,
+                                  const PolicyOptions& options) {
+    std::vector<SweepResult> results(grid.size());
+    if (grid.empty()) {
+        return results;
+    }
+    ThreadPool pool(std::max(1, threads));
+
+    // Configurations with at least `shards` sets split into that many tasks,
+    // shard s owning the sets whose index is s modulo shards
+    int shards = 1;
+    while (threads > 1 && shards < 2 * threads) {
+        shards *= 2;
+    }
+    int shardBits = static_cast<int>(std::log2(shards));
+
+    std::vector<SweepConfig> configs(grid.size());
+    std::map<int, std::unique_ptr<BlockSizeGroup>> groups;
+    std::vector<std::pair<double, size_t>> wholeJobs;
+    std::vector<std::vector<ShardResult>> shardResults(grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        configs[i] = {Cache::roundToPowerOfTwo(grid[i].blockSize),
+                      Cache::roundToPowerOfTwo(grid[i].numSets), grid[i].ways, grid[i].policy};
+        AddressParser validate(N, configs[i].blockSize, configs[i].numSets);
+        if (configs[i].ways <= 0) {
+            throw std::invalid_argument("Cache parameters must be positive");
+        }
+        if (policyNeedsPc(configs[i].policy)) {
+            throw std::invalid_argument(getPolicyName(configs[i].policy) +
+                                        " needs per-access PCs, which sweeps do not keep");
+        }
+        double cost = estimateCost(configs[i], trace.size());
+        bool vectorized = LaneSimulator::supports(configs[i].ways, configs[i].policy);
+        bool sharded = !vectorized && shards > 1 && configs[i].numSets >= shards &&
+                       configs[i].policy != ReplacementPolicy::OPTIMAL &&
+                       !policySharesState(configs[i].policy);
+        if (vectorized || sharded) {
+            auto& group = groups[configs[i].blockSize];
+            if (!group) {
+                group = std::make_unique<BlockSizeGroup>();
+            }
+            if (vectorized) {
+                group->laneJobs[configs[i].ways].push_back(i);
+            } else {
+                group->jobs.emplace_back(cost / shards, i);
+                shardResults[i].resize(shards);
+            }
+        } else {
+            wholeJobs.emplace_back(cost, i);
+        }
+    }
+
+    // OPTIMAL configurations of a block size share one look-ahead pass,
+    // itself split across the threads before the jobs start
+    std::map<int, std::shared_ptr<const std::vector<uint64_t>>> nextUse;
+    for (const auto& [cost, i] : wholeJobs) {
+        auto& times = nextUse[configs[i].blockSize];
+        if (configs[i].policy == ReplacementPolicy::OPTIMAL && !times) {
+            times = std::make_shared<const std::vector<uint64_t>>(
+                computeNextUse(trace, configs[i].blockSize, threads));
+        }
+    }
+
+    // Owners run their newest task first, so queue cheap jobs before costly
+    // ones; a worker that finishes early steals the cheap leftovers
+    std::sort(wholeJobs.begin(), wholeJobs.end());
+    for (const auto& [cost, i] : wholeJobs) {
+        pool.submit([&, i = i] {
+            const SweepConfig& config = configs[i];
+            Cache cache(N, config.blockSize, config.numSets, config.ways, config.policy, 1.0,
+                        options);
+            if (config.policy == ReplacementPolicy::OPTIMAL) {
+                cache.setNextUse(nextUse.at(config.blockSize));
+            }
+            for (uint64_t address : trace) {
+                cache.simulate(address);
+            }
+            results[i] = {config, cache.getStats()};
+        });
+    }
+
+    // Vectorized and sharded jobs share one stack-distance pass per block
+    // size, and sharded jobs one partition; the task preparing them then
+    // spawns rows of lanes and every shard onto its worker
+    for (auto& [blockSize, groupPtr] : groups) {
+        BlockSizeGroup* group = groupPtr.get();
+        pool.submit([&, blockSize = blockSize, group] {
+            group->distances = computeStackDistances(trace, blockSize);
+            if (!group->jobs.empty()) {
+                partitionTrace(trace, blockSize, shards, group->order, group->shardStart);
+            }
+
+            for (const auto& [ways, jobs] : group->laneJobs) {
+                for (size_t first = 0; first < jobs.size(); first += LaneSimulator::LANES) {
+                    size_t last = std::min(jobs.size(), first + LaneSimulator::LANES);
+                    std::vector<size_t> row(jobs.begin() + first, jobs.begin() + last);
+                    pool.submit([&, blockSize, group, ways = ways, row] {
+                        std::vector<LaneSimulator::Lane> lanes;
+                        for (size_t i : row) {
+                            lanes.push_back({configs[i].numSets, configs[i].policy});
+                        }
+                        LaneSimulator sim(blockSize, ways, lanes);
+                        sim.run(trace, group->distances);
+                        for (size_t l = 0; l < row.size(); ++l) {
+                            results[row[l]] = {configs[row[l]], sim.getStats(l)};
+                        }
+                    });
+                }
+            }
+
+            std::sort(group->jobs.begin(), group->jobs.end());
+            for (const auto& [cost, i] : group->jobs) {
+                for (int s = 0; s < shards; ++s) {
+                    pool.submit([&, group, i = i, s] {
+                        shardResults[i][s] = simulateShard(
+                            configs[i], trace, *group,
+                            group->order.data() + group->shardStart[s],
+                            group->order.data() + group->shardStart[s + 1], s, shardBits,
+                            options);
+                    });
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    for (size_t i = 0; i < grid.size(); ++i) {
+        if (shardResults[i].empty()) {
+            continue;
+        }
+        CacheStats stats;
+        stats.setConfiguration(configs[i].ways, configs[i].policy);
+        stats.totalAccesses = trace.size();
+        for (const auto& part : shardResults[i]) {
+            stats.hits += part.hits;
+            stats.misses += part.misses;
+            stats.coldMisses += part.coldMisses;
+            stats.conflictMisses += part.conflictMisses;
+        }
+        stats.capacityMisses = stats.misses - stats.coldMisses - stats.conflictMisses;
+        results[i] = {configs[i], stats};
+    }
+    return results;
+}
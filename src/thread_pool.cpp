@@ -0,0 +1,121 @@
+#include "thread_pool.hpp"
+#include <stdexcept>
+
+namespace {
+// Lets submit() tell a task spawning subtasks apart from an outside caller
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentWorker = -1;
+}
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) {
+        throw std::invalid_argument("Thread pool needs at least one thread");
+    }
+    queues.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t target = currentPool == this
+        ? static_cast<size_t>(currentWorker)
+        : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued++;
+        pending++;
+    }
+    taskReady.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+    if (firstError) {
+        std::exception_ptr error = firstError;
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::takeTask(int worker, std::function<void()>& task) {
+    // Own deque newest first, for locality and so a job's pieces stay close
+    {
+        WorkerQueue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // Then steal the oldest task of the next busy worker
+    for (size_t step = 1; step < queues.size(); ++step) {
+        WorkerQueue& victim = *queues[(worker + step) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int worker) {
+    currentPool = this;
+    currentWorker = worker;
+    while (true) {
+        {
+            // Claim one queued task before searching, so sleeping is only
+            // ever decided under the lock and no wakeup is lost
+            std::unique_lock<std::mutex> lock(mutex);
+            taskReady.wait(lock, [this] { return stopping || queued > 0; });
+            if (queued == 0) {
+                return;
+            }
+            queued--;
+        }
+
+        // A claimed task is always in some deque, but concurrent takes can
+        // leave it in one this search already passed; retry until found
+        std::function<void()> task;
+        while (!takeTask(worker, task)) {
+            std::this_thread::yield();
+        }
+
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!firstError) {
+                firstError = std::current_exception();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            allDone.notify_all();
+        }
+    }
+}
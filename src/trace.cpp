@@ -0,0 +1,155 @@
+#include "trace.hpp"
+#include <glob.h>
+#include <stdexcept>
+
+namespace {
+// Start of the field after the address, or npos on a one-field line
+size_t secondField(const std::string& line) {
+    size_t start = line.find_first_not_of(" \t");
+    size_t end = line.find_first_of(" \t\r", start);
+    return end == std::string::npos ? end : line.find_first_not_of(" \t\r", end);
+}
+
+// Whether the field at pos is a PC rather than a decimal timestamp
+bool isPcField(const std::string& line, size_t pos) {
+    if (pos == std::string::npos) {
+        return false;
+    }
+    if (line[pos] == 'x' || line[pos] == 'X') {
+        return true;
+    }
+    return line[pos] == '0' && pos + 1 < line.size() && (line[pos + 1] == 'x' || line[pos + 1] == 'X');
+}
+}
+
+uint64_t parseHexAddress(const std::string& text) {
+    size_t pos = 0;
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) {
+        ++pos;
+    }
+    if (pos + 1 < text.size() && text[pos] == '0' && (text[pos + 1] == 'x' || text[pos + 1] == 'X')) {
+        pos += 2;
+    } else if (pos < text.size() && (text[pos] == 'x' || text[pos] == 'X')) {
+        ++pos;
+    }
+
+    uint64_t value = 0;
+    size_t digits = 0;
+    for (; pos < text.size(); ++pos, ++digits) {
+        char c = text[pos];
+        uint64_t nibble;
+        if (c >= '0' && c <= '9') nibble = c - '0';
+        else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+        else break;
+        value = (value << 4) | nibble;
+    }
+
+    if (digits == 0) {
+        throw std::runtime_error("Invalid address format: " + text);
+    }
+    return value;
+}
+
+TraceReader::TraceReader(const std::string& filename) : file(filename) {
+    if (!file) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+}
+
+bool TraceReader::next(uint64_t& address) {
+    while (std::getline(file, line)) {
+        if (line.empty() || line == "\r") {
+            continue;
+        }
+        address = parseHexAddress(line);
+        return true;
+    }
+    return false;
+}
+
+bool TraceReader::next(uint64_t& address, uint64_t& timestamp) {
+    if (!next(address)) {
+        return false;
+    }
+    size_t field = secondField(line);
+    if (isPcField(line, field)) {
+        size_t end = line.find_first_of(" \t\r", field);
+        field = end == std::string::npos ? end : line.find_first_not_of(" \t\r", end);
+    }
+    size_t used = 0;
+    try {
+        timestamp = field == std::string::npos ? 0 : std::stoull(line.substr(field), &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0) {
+        throw std::runtime_error("Missing timestamp: " + line);
+    }
+    return true;
+}
+
+bool TraceReader::next(TraceAccess& access) {
+    if (!next(access.address)) {
+        return false;
+    }
+    size_t field = secondField(line);
+    if (isPcField(line, field)) {
+        access.pc = parseHexAddress(line.substr(field));
+    } else if (!pcRequiredBy.empty()) {
+        throw std::runtime_error(pcRequiredBy + " needs a PC on every trace line (\"0xADDR 0xPC\"): " + line);
+    } else {
+        access.pc = 0;
+    }
+    return true;
+}
+
+void TraceReader::requirePc(const std::string& policyName) {
+    pcRequiredBy = policyName;
+}
+
+std::vector<uint64_t> loadTrace(const std::string& filename, std::vector<uint64_t>* pcs,
+                                const std::string& pcRequiredBy) {
+    TraceReader reader(filename);
+    std::vector<uint64_t> trace;
+    if (pcs) {
+        reader.requirePc(pcRequiredBy);
+        pcs->clear();
+        TraceAccess access;
+        while (reader.next(access)) {
+            trace.push_back(access.address);
+            pcs->push_back(access.pc);
+        }
+        return trace;
+    }
+    uint64_t address;
+    while (reader.next(address)) {
+        trace.push_back(address);
+    }
+    return trace;
+}
+
+std::vector<std::string> expandTraceFiles(const std::vector<std::string>& patterns) {
+    std::vector<std::string> files;
+    for (const auto& pattern : patterns) {
+        if (pattern.find_first_of("*?[") == std::string::npos) {
+            files.push_back(pattern);
+            continue;
+        }
+        glob_t matches;
+        int status = glob(pattern.c_str(), 0, nullptr, &matches);
+        if (status == GLOB_NOMATCH) {
+            globfree(&matches);
+            throw std::runtime_error("No trace files match: " + pattern);
+        }
+        if (status != 0) {
+            globfree(&matches);
+            throw std::runtime_error("Could not expand pattern: " + pattern);
+        }
+        for (size_t i = 0; i < matches.gl_pathc; ++i) {
+            files.emplace_back(matches.gl_pathv[i]);
+        }
+        globfree(&matches);
+    }
+    return files;
+}
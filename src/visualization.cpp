@@ -4,88 +4,128 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include "policies.hpp"
 
-void CacheVisualizer::printResults(const std::vector<Cache::AccessResult>& results, const CacheStats& stats) {
-    std::cout << "Cache Configuration:\n";
-    std::cout << "Association: " << stats.ways << "-way\n";
-    std::cout << "Replacement Policy: " << getPolicyName(stats.policy) << "\n\n";
-
-    const size_t MIN_ADDR = 12;
-    const size_t MIN_TAG = 6;
-    const size_t MIN_INDEX = 6;
-    const size_t MIN_OFFSET = 12;
-    const size_t MIN_HM = 4;
-    const size_t MIN_REPL = 15;
-    const size_t SPACING = 1;
-
-    size_t addrWidth = MIN_ADDR;
-    size_t tagWidth = MIN_TAG;
-    size_t indexWidth = MIN_INDEX;
-    size_t offsetWidth = MIN_OFFSET;
-    size_t hmWidth = MIN_HM;
-    size_t replWidth = MIN_REPL;
+namespace {
+const size_t MIN_ADDR = 12;
+const size_t MIN_TAG = 6;
+const size_t MIN_INDEX = 6;
+const size_t MIN_OFFSET = 12;
+const size_t MIN_HM = 4;
+const size_t MIN_REPL = 15;
+const size_t SPACING = 1;
 
-    for (const auto& result : results) {
-        addrWidth = std::max(addrWidth, result.originalAddress.length() + SPACING);
-        tagWidth = std::max(tagWidth, result.tag.length() + SPACING);
-        indexWidth = std::max(indexWidth, result.index.length() + SPACING);
-        offsetWidth = std::max(offsetWidth, result.offset.length() + SPACING);
-        replWidth = std::max(replWidth, result.replacementInfo.length() + SPACING);
-    }
+size_t hexWidth(int bits) {
+    return 2 + std::max(1, (bits + 3) / 4);   // "0x" and at least one digit
+}
 
+CacheVisualizer::TableLayout fitTerminal(CacheVisualizer::TableLayout layout) {
     struct winsize w;
     ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
     size_t termWidth = w.ws_col;
     size_t minWidth = MIN_ADDR + MIN_TAG + MIN_INDEX + MIN_OFFSET + MIN_HM + MIN_REPL + 5;
 
     if (termWidth < minWidth) {
-        addrWidth = MIN_ADDR;
-        tagWidth = MIN_TAG;
-        indexWidth = MIN_INDEX;
-        offsetWidth = MIN_OFFSET;
-        hmWidth = MIN_HM;
-        replWidth = MIN_REPL;
+        layout = {MIN_ADDR, MIN_TAG, MIN_INDEX, MIN_OFFSET, MIN_HM, MIN_REPL};
     }
+    return layout;
+}
 
-    auto truncate = [](const std::string& str, size_t width) -> std::string {
-        if (str.length() > width - 1) {
-            return str.substr(0, width - 2) + ".";
-        }
-        return str;
-    };
+std::string truncate(const std::string& str, size_t width) {
+    if (str.length() > width - 1) {
+        return str.substr(0, width - 2) + ".";
+    }
+    return str;
+}
 
-    auto formatCol = [](const std::string& str, size_t width) {
-        std::stringstream ss;
-        ss << std::left << std::setw(width) << str;
-        return ss.str();
-    };
+std::string formatCol(const std::string& str, size_t width) {
+    std::stringstream ss;
+    ss << std::left << std::setw(width) << str;
+    return ss.str();
+}
+}
 
-    std::cout << formatCol("Address", addrWidth)
-              << formatCol("Tag", tagWidth)
-              << formatCol("Index", indexWidth)
-              << formatCol("Offset", offsetWidth)
-              << formatCol("H/M", hmWidth)
-              << "Replacement\n";
+CacheVisualizer::TableLayout CacheVisualizer::tableLayout(const std::vector<Cache::AccessResult>& results) {
+    TableLayout layout{MIN_ADDR, MIN_TAG, MIN_INDEX, MIN_OFFSET, MIN_HM, MIN_REPL};
+    for (const auto& result : results) {
+        layout.addrWidth = std::max(layout.addrWidth, result.originalAddress.length() + SPACING);
+        layout.tagWidth = std::max(layout.tagWidth, result.tag.length() + SPACING);
+        layout.indexWidth = std::max(layout.indexWidth, result.index.length() + SPACING);
+        layout.offsetWidth = std::max(layout.offsetWidth, result.offset.length() + SPACING);
+        layout.replWidth = std::max(layout.replWidth, result.replacementInfo.length() + SPACING);
+    }
+    return fitTerminal(layout);
+}
+
+CacheVisualizer::TableLayout CacheVisualizer::tableLayout(const Cache& cache) {
+    // Widest fields an N-bit address can produce in this geometry
+    int offsetBits = static_cast<int>(std::log2(cache.getBlockSize()));
+    int indexBits = static_cast<int>(std::log2(cache.getNumSets()));
+    int tagBits = cache.getAddressBits() - offsetBits - indexBits;
+    size_t wayDigits = std::to_string(std::max(0, cache.getStats().ways - 1)).length();
+    std::string widestRepl = "Replaced way " + std::string(wayDigits, '0') +
+                             " (old tag: " + std::string(hexWidth(tagBits), '0') + ")";
+
+    TableLayout layout{MIN_ADDR, MIN_TAG, MIN_INDEX, MIN_OFFSET, MIN_HM, MIN_REPL};
+    layout.addrWidth = std::max(layout.addrWidth, hexWidth(cache.getAddressBits()) + SPACING);
+    layout.tagWidth = std::max(layout.tagWidth, hexWidth(tagBits) + SPACING);
+    layout.indexWidth = std::max(layout.indexWidth, hexWidth(indexBits) + SPACING);
+    layout.replWidth = std::max(layout.replWidth, widestRepl.length() + SPACING);
+    return fitTerminal(layout);
+}
 
-    std::cout << std::string(addrWidth, '-') << " "
-              << std::string(tagWidth, '-') << " "
-              << std::string(indexWidth, '-') << " "
-              << std::string(offsetWidth, '-') << " "
-              << std::string(hmWidth, '-') << " "
-              << std::string(replWidth, '-') << "\n";
+void CacheVisualizer::printTableHeader(std::ostream& out, const CacheStats& stats, const TableLayout& layout) {
+    out << "Cache Configuration:\n";
+    out << "Association: " << stats.ways << "-way\n";
+    out << "Replacement Policy: " << getPolicyName(stats.policy) << "\n\n";
 
+    out << formatCol("Address", layout.addrWidth)
+        << formatCol("Tag", layout.tagWidth)
+        << formatCol("Index", layout.indexWidth)
+        << formatCol("Offset", layout.offsetWidth)
+        << formatCol("H/M", layout.hmWidth)
+        << "Replacement\n";
+
+    out << std::string(layout.addrWidth, '-') << " "
+        << std::string(layout.tagWidth, '-') << " "
+        << std::string(layout.indexWidth, '-') << " "
+        << std::string(layout.offsetWidth, '-') << " "
+        << std::string(layout.hmWidth, '-') << " "
+        << std::string(layout.replWidth, '-') << "\n";
+}
+
+void CacheVisualizer::printTableRow(std::ostream& out, const Cache::AccessResult& result,
+                                    const TableLayout& layout) {
+    out << formatCol(truncate(result.originalAddress, layout.addrWidth), layout.addrWidth)
+        << formatCol(truncate(result.tag, layout.tagWidth), layout.tagWidth)
+        << formatCol(truncate(result.index, layout.indexWidth), layout.indexWidth)
+        << formatCol(truncate(result.offset, layout.offsetWidth), layout.offsetWidth)
+        << formatCol(std::string(1, result.hitMiss), layout.hmWidth)
+        << truncate(result.replacementInfo, layout.replWidth) << "\n";
+}
+
+void CacheVisualizer::printResults(const std::vector<Cache::AccessResult>& results, const CacheStats& stats) {
+    TableLayout layout = tableLayout(results);
+    printTableHeader(std::cout, stats, layout);
     for (const auto& result : results) {
-        std::cout << formatCol(truncate(result.originalAddress, addrWidth), addrWidth)
-                  << formatCol(truncate(result.tag, tagWidth), tagWidth)
-                  << formatCol(truncate(result.index, indexWidth), indexWidth)
-                  << formatCol(truncate(result.offset, offsetWidth), offsetWidth)
-                  << formatCol(std::string(1, result.hitMiss), hmWidth)
-                  << truncate(result.replacementInfo, replWidth) << "\n";
+        printTableRow(std::cout, result, layout);
     }
 
+    printStatistics(stats);
+}
+
+void CacheVisualizer::printSummary(const CacheStats& stats) {
+    std::cout << "Cache Configuration:\n";
+    std::cout << "Association: " << stats.ways << "-way\n";
+    std::cout << "Replacement Policy: " << getPolicyName(stats.policy) << "\n";
+    printStatistics(stats);
+}
+
+void CacheVisualizer::printStatistics(const CacheStats& stats) {
     std::cout << "\nCache Statistics:\n";
     std::cout << "----------------\n";
     std::cout << "Total Accesses: " << stats.totalAccesses << "\n";
@@ -93,6 +133,7 @@ void CacheVisualizer::printResults(const std::vector<Cache::AccessResult>& resul
     std::cout << "Misses: " << stats.misses << "\n";
     std::cout << "Cold Misses: " << stats.coldMisses << "\n";
     std::cout << "Conflict Misses: " << stats.conflictMisses << "\n";
+    std::cout << "Capacity Misses: " << stats.capacityMisses << "\n";
     std::cout << "Hit Rate: " << std::fixed << std::setprecision(4) 
               << (stats.totalAccesses > 0 ? 
                   (static_cast<double>(stats.hits) / stats.totalAccesses * 100) : 0)
@@ -141,3 +182,302 @@ void CacheVisualizer::generateVisualization(
         std::cerr << "Error: " << e.what() << std::endl;
     }
 }
+
+void CacheVisualizer::printSetSampleEstimate(const CacheStats& stats, const SetSampleEstimate& estimate) {
+    std::cout << "Cache Configuration:\n";
+    std::cout << "Association: " << stats.ways << "-way\n";
+    std::cout << "Replacement Policy: " << getPolicyName(stats.policy) << "\n";
+    std::cout << "Sampled Sets: " << estimate.sampledSets << " of " << estimate.totalSets << "\n\n";
+
+    std::cout << "Estimated Cache Statistics:\n";
+    std::cout << "--------------------------\n";
+    std::cout << "Total Accesses: " << estimate.totalAccesses
+              << " (" << estimate.sampledAccesses << " simulated)\n";
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "Hits: " << stats.hits * estimate.scale << "\n";
+    std::cout << "Misses: " << stats.misses * estimate.scale << "\n";
+    std::cout << "Cold Misses: " << stats.coldMisses * estimate.scale << "\n";
+    std::cout << "Conflict Misses: " << stats.conflictMisses * estimate.scale << "\n";
+    std::cout << "Capacity Misses: " << stats.capacityMisses * estimate.scale << "\n";
+    std::cout << std::setprecision(4) << "Hit Rate: " << estimate.hitRate << "%";
+    if (std::isnan(estimate.marginOfError)) {
+        std::cout << " (confidence interval needs at least 2 sampled sets)\n";
+    } else {
+        std::cout << " +/- " << estimate.marginOfError << "% (95% confidence)\n";
+    }
+}
+
+void CacheVisualizer::printSweepResults(const std::vector<SweepResult>& results) {
+    std::cout << "Parameter Sweep Results:\n\n";
+    std::cout << std::left << std::setw(7) << "Block"
+              << std::setw(8) << "Sets"
+              << std::setw(6) << "Ways"
+              << std::setw(9) << "Policy"
+              << std::setw(12) << "Accesses"
+              << std::setw(12) << "Hits"
+              << std::setw(12) << "Misses"
+              << std::setw(12) << "Cold"
+              << std::setw(12) << "Conflict"
+              << std::setw(12) << "Capacity"
+              << "Hit Rate\n";
+    std::cout << std::string(6, '-') << " " << std::string(7, '-') << " "
+              << std::string(5, '-') << " " << std::string(8, '-');
+    for (int c = 0; c < 6; ++c) {
+        std::cout << " " << std::string(11, '-');
+    }
+    std::cout << " " << std::string(9, '-') << "\n";
+
+    for (const auto& result : results) {
+        const CacheStats& stats = result.stats;
+        std::cout << std::left << std::setw(7) << result.config.blockSize
+                  << std::setw(8) << result.config.numSets
+                  << std::setw(6) << result.config.ways
+                  << std::setw(9) << getPolicyName(result.config.policy)
+                  << std::setw(12) << stats.totalAccesses
+                  << std::setw(12) << stats.hits
+                  << std::setw(12) << stats.misses
+                  << std::setw(12) << stats.coldMisses
+                  << std::setw(12) << stats.conflictMisses
+                  << std::setw(12) << stats.capacityMisses
+                  << std::fixed << std::setprecision(4) << stats.getHitRate() << "%\n";
+    }
+}
+
+void CacheVisualizer::printPolicyComparison(const PolicyComparison& comparison) {
+    const auto& results = comparison.getStats();
+    std::cout << "Policy Comparison:\n";
+    std::cout << "Block size: " << comparison.getBlockSize() << " bytes, "
+              << comparison.getNumSets() << " sets, "
+              << (results.empty() ? 0 : results.front().ways) << "-way\n";
+    std::cout << "Total Accesses: " << (results.empty() ? 0 : results.front().totalAccesses) << "\n\n";
+
+    std::cout << std::left << std::setw(17) << "Metric";
+    for (const auto& stats : results) {
+        std::cout << std::setw(12) << getPolicyName(stats.policy);
+    }
+    std::cout << "\n" << std::string(16, '-');
+    for (size_t c = 0; c < results.size(); ++c) {
+        std::cout << " " << std::string(11, '-');
+    }
+    std::cout << "\n";
+
+    auto printRow = [&](const std::string& name, uint64_t CacheStats::*field) {
+        std::cout << std::left << std::setw(17) << name;
+        for (const auto& stats : results) {
+            std::cout << std::setw(12) << stats.*field;
+        }
+        std::cout << "\n";
+    };
+    printRow("Hits", &CacheStats::hits);
+    printRow("Misses", &CacheStats::misses);
+    printRow("Cold Misses", &CacheStats::coldMisses);
+    printRow("Conflict Misses", &CacheStats::conflictMisses);
+    printRow("Capacity Misses", &CacheStats::capacityMisses);
+
+    std::cout << std::left << std::setw(17) << "Hit Rate";
+    for (const auto& stats : results) {
+        std::ostringstream rate;
+        rate << std::fixed << std::setprecision(4) << stats.getHitRate() << "%";
+        std::cout << std::setw(12) << rate.str();
+    }
+    std::cout << "\n";
+}
+
+void CacheVisualizer::printBatchResults(const std::vector<BatchResult>& results) {
+    size_t fileWidth = 6;
+    for (const auto& result : results) {
+        fileWidth = std::max(fileWidth, result.filename.length() + 1);
+    }
+
+    if (!results.empty()) {
+        std::cout << "Cache Configuration:\n";
+        std::cout << "Association: " << results.front().stats.ways << "-way\n";
+        std::cout << "Replacement Policy: " << getPolicyName(results.front().stats.policy) << "\n\n";
+    }
+
+    std::cout << std::left << std::setw(fileWidth) << "File"
+              << std::setw(12) << "Accesses"
+              << std::setw(12) << "Hits"
+              << std::setw(12) << "Misses"
+              << std::setw(12) << "Cold"
+              << std::setw(12) << "Conflict"
+              << std::setw(12) << "Capacity"
+              << "Hit Rate\n";
+    std::cout << std::string(fileWidth - 1, '-');
+    for (int c = 0; c < 6; ++c) {
+        std::cout << " " << std::string(11, '-');
+    }
+    std::cout << " " << std::string(9, '-') << "\n";
+
+    auto printRow = [&](const std::string& name, const CacheStats& stats) {
+        std::cout << std::left << std::setw(fileWidth) << name
+                  << std::setw(12) << stats.totalAccesses
+                  << std::setw(12) << stats.hits
+                  << std::setw(12) << stats.misses
+                  << std::setw(12) << stats.coldMisses
+                  << std::setw(12) << stats.conflictMisses
+                  << std::setw(12) << stats.capacityMisses
+                  << std::fixed << std::setprecision(4) << stats.getHitRate() << "%\n";
+    };
+
+    CacheStats total;
+    size_t failed = 0;
+    for (const auto& result : results) {
+        if (!result.error.empty()) {
+            std::cout << std::left << std::setw(fileWidth) << result.filename
+                      << "Error: " << result.error << "\n";
+            failed++;
+            continue;
+        }
+        printRow(result.filename, result.stats);
+        total.totalAccesses += result.stats.totalAccesses;
+        total.hits += result.stats.hits;
+        total.misses += result.stats.misses;
+        total.coldMisses += result.stats.coldMisses;
+        total.conflictMisses += result.stats.conflictMisses;
+        total.capacityMisses += result.stats.capacityMisses;
+    }
+
+    std::cout << std::string(fileWidth - 1, '-');
+    for (int c = 0; c < 6; ++c) {
+        std::cout << " " << std::string(11, '-');
+    }
+    std::cout << " " << std::string(9, '-') << "\n";
+    printRow("Total", total);
+    std::cout << "\n" << results.size() - failed << " of " << results.size()
+              << " files simulated\n";
+}
+
+void CacheVisualizer::printMultiCoreResults(const MultiCoreSimulator& sim) {
+    std::vector<std::string> names;
+    for (size_t c = 0; c < sim.getCoreCount(); ++c) {
+        names.push_back("core " + std::to_string(c) + " (" + sim.getCoreFile(c) + ")");
+    }
+    size_t nameWidth = 7;
+    for (const auto& name : names) {
+        nameWidth = std::max(nameWidth, name.length() + 1);
+    }
+
+    const CacheStats& first = sim.getCoreStats(0);
+    std::cout << "Multi-core Configuration:\n";
+    std::cout << "Cores: " << sim.getCoreCount() << "\n";
+    std::cout << "Private caches: " << first.ways << "-way, "
+              << getPolicyName(first.policy) << "\n";
+    if (sim.hasSharedCache()) {
+        std::cout << "Shared cache: " << sim.getSharedStats().ways << "-way, "
+                  << getPolicyName(sim.getSharedStats().policy) << "\n";
+    }
+    std::cout << "\n";
+
+    std::cout << std::left << std::setw(nameWidth) << "Cache"
+              << std::setw(12) << "Accesses"
+              << std::setw(12) << "Hits"
+              << std::setw(12) << "Misses"
+              << std::setw(12) << "Cold"
+              << std::setw(12) << "Conflict"
+              << std::setw(12) << "Capacity"
+              << "Hit Rate\n";
+    auto printRule = [&] {
+        std::cout << std::string(nameWidth - 1, '-');
+        for (int c = 0; c < 6; ++c) {
+            std::cout << " " << std::string(11, '-');
+        }
+        std::cout << " " << std::string(9, '-') << "\n";
+    };
+    auto printRow = [&](const std::string& name, const CacheStats& stats) {
+        std::cout << std::left << std::setw(nameWidth) << name
+                  << std::setw(12) << stats.totalAccesses
+                  << std::setw(12) << stats.hits
+                  << std::setw(12) << stats.misses
+                  << std::setw(12) << stats.coldMisses
+                  << std::setw(12) << stats.conflictMisses
+                  << std::setw(12) << stats.capacityMisses
+                  << std::fixed << std::setprecision(4) << stats.getHitRate() << "%\n";
+    };
+
+    printRule();
+    for (size_t c = 0; c < sim.getCoreCount(); ++c) {
+        printRow(names[c], sim.getCoreStats(c));
+    }
+    if (sim.hasSharedCache()) {
+        printRule();
+        printRow("Shared", sim.getSharedStats());
+    }
+}
+
+void CacheVisualizer::printAllAssociativity(const AllAssociativitySimulator& sim) {
+    std::cout << "All-Associativity LRU Simulation:\n";
+    std::cout << "Block size: " << sim.getBlockSize() << " bytes\n";
+    std::cout << "Total Accesses: " << sim.getTotalAccesses() << "\n\n";
+
+    std::cout << std::left << std::setw(10) << "Sets"
+              << std::setw(8) << "Ways"
+              << std::setw(12) << "Blocks"
+              << std::setw(14) << "Hits"
+              << std::setw(14) << "Misses"
+              << "Hit Rate\n";
+    std::cout << std::string(9, '-') << " " << std::string(7, '-') << " "
+              << std::string(11, '-') << " " << std::string(13, '-') << " "
+              << std::string(13, '-') << " " << std::string(9, '-') << "\n";
+
+    for (int k = 0; k <= sim.getMaxIndexBits(); ++k) {
+        uint64_t numSets = uint64_t{1} << k;
+        for (int ways = 1; ways <= sim.getMaxWays(); ++ways) {
+            uint64_t hits = sim.getHits(k, ways);
+            double hitRate = sim.getTotalAccesses() > 0
+                ? static_cast<double>(hits) / sim.getTotalAccesses() * 100 : 0;
+            std::cout << std::left << std::setw(10) << numSets
+                      << std::setw(8) << ways
+                      << std::setw(12) << numSets * ways
+                      << std::setw(14) << hits
+                      << std::setw(14) << sim.getMisses(k, ways)
+                      << std::fixed << std::setprecision(4) << hitRate << "%\n";
+        }
+    }
+}
+
+void CacheVisualizer::printMissRatioCurve(const std::string& title, const MissRatioCurve& curve) {
+    printMissRatioCurves(title, {{"Miss Ratio", curve}});
+}
+
+void CacheVisualizer::printMissRatioCurves(
+    const std::string& title,
+    const std::vector<std::pair<std::string, MissRatioCurve>>& curves) {
+    if (curves.empty()) {
+        return;
+    }
+    const MissRatioCurve& first = curves.front().second;
+    std::cout << title << ":\n";
+    std::cout << "Block size: " << first.blockSize << " bytes\n";
+    std::cout << "Total Accesses: " << first.totalAccesses << "\n\n";
+
+    // Curves share bucket boundaries; a shorter curve stays flat past its end
+    const MissRatioCurve* longest = &first;
+    for (const auto& [name, curve] : curves) {
+        if (curve.capacities.size() > longest->capacities.size()) {
+            longest = &curve;
+        }
+    }
+
+    std::cout << std::left << std::setw(14) << "Blocks" << std::setw(16) << "Bytes";
+    for (const auto& [name, curve] : curves) {
+        std::cout << std::setw(14) << name;
+    }
+    std::cout << "\n" << std::string(13, '-') << " " << std::string(15, '-');
+    for (size_t c = 0; c < curves.size(); ++c) {
+        std::cout << " " << std::string(13, '-');
+    }
+    std::cout << "\n";
+
+    for (size_t i = 0; i < longest->capacities.size(); ++i) {
+        uint64_t capacity = longest->capacities[i];
+        std::cout << std::left << std::setw(14) << capacity
+                  << std::setw(16) << capacity * first.blockSize;
+        for (const auto& [name, curve] : curves) {
+            double missRatio = curve.missRatios.empty() ? 1.0
+                : curve.missRatios[std::min(i, curve.missRatios.size() - 1)];
+            std::cout << std::setw(14) << std::fixed << std::setprecision(6) << missRatio;
+        }
+        std::cout << "\n";
+    }
+}